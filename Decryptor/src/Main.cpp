@@ -6,9 +6,14 @@
 #include <memory>
 #include <vector>
 #include <QApplication>
+#include <QDebug>
 
 #include "utils/ConfigManager.hpp"
+#include "utils/HashCache.hpp"
+#include "utils/SimilarityIndex.hpp"
 #include "utils/StylesManager.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/TrustedKeyStore.hpp"
 #include "window/mainwindow/MainWindow.hpp"
 
 #if defined(WIN32) && defined(DEBUG)
@@ -27,6 +32,16 @@ int main(int argc, char **argv)
 #endif
 
     utils::ConfigManager::getInstance().loadConfig();
+    utils::ThreadPool::getInstance().setThreadCount(
+            static_cast<std::size_t>(utils::ConfigManager::getInstance().getWorkerThreads()));
+    utils::TrustedKeyStore::getInstance().load(
+            QString::fromStdString(utils::ConfigManager::getInstance().getTrustedKeysPath()));
+    if (!utils::SimilarityIndex::getInstance().load(QString::fromStdString(
+                utils::ConfigManager::getInstance().getSimilarityIndexPath())))
+        qDebug() << "Similarity index is not valid, starting with an empty index.";
+    if (!utils::HashCache::getInstance().load(
+                QString::fromStdString(utils::ConfigManager::getInstance().getHashCachePath())))
+        qDebug() << "Hash cache is not valid, starting with an empty cache.";
     utils::StylesManager::getInstance().addGlobalStylesheet(
             QStringLiteral(":/Themes/Default/Master.qss"));
 
@@ -31,6 +31,7 @@ public:
     createDefaultImageSigner(QImage image, const key_generator::ICryptoKeyGenerator *pbKey,
                              const key_generator::ICryptoKeyGenerator *prKey,
                              const db::data::Author *author);
+    std::unique_ptr<ICodec> createDefaultImageSignExtractor(QImage image) override;
 
 private:
     /**
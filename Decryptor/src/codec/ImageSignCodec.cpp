@@ -3,12 +3,14 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
-#include <QColor>
 #include <QDebug>
 
+#include <algorithm>
 #include <array>
-#include <bitset>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 #include <boost/assert.hpp>
@@ -16,8 +18,12 @@
 
 #include "codec/ImageSignCodec.hpp"
 #include "codec/DefaultCodecFactory.hpp"
+#include "codec/SignaturePayload.hpp"
 #include "generator/PublicRSACryptoKeyGenerator.hpp"
-#include "utils/DCT.hpp"
+#include "utils/BlockDCT.hpp"
+#include "utils/JPEGCoefficients.hpp"
+#include "utils/JPEGStripTranscoder.hpp"
+#include "utils/ThreadPool.hpp"
 
 #ifdef DEBUG
 #include <QFile>
@@ -27,6 +33,13 @@
 
 
 namespace codec {
+namespace {
+/**
+ * @brief Amount of bands scheduled per worker thread, more bands than workers balance uneven bands.
+ */
+constexpr int bandsPerWorker { 4 };
+}
+
 ImageSignCodec::ImageSignCodec(QImage image, const key_generator::ICryptoKeyGenerator *pbKey,
                                const key_generator::ICryptoKeyGenerator *prKey,
                                const db::data::Author *author)
@@ -42,171 +55,115 @@ ImageSignCodec::ImageSignCodec(QImage image, const key_generator::ICryptoKeyGene
         throw std::invalid_argument { "Parameter author must not be nullptr but it seems to be." };
 }
 
-void ImageSignCodec::setCodecData(std::vector<std::byte>)
+void ImageSignCodec::setCodecData(std::vector<std::byte> data)
 {
-    throw std::logic_error { "codec::ImageSignCodec does not support this operation" };
+    jpeg_ = std::move(data);
 }
 
-void ImageSignCodec::setCodecData(std::string_view)
+void ImageSignCodec::setCodecData(std::string_view data)
 {
-    throw std::logic_error { "codec::ImageSignCodec does not support this operation" };
+    auto begData = reinterpret_cast<const std::byte *>(data.data());
+    jpeg_.assign(begData, begData + data.size());
 }
 
-void ImageSignCodec::setCodecData(const std::byte *, std::size_t)
+void ImageSignCodec::setCodecData(const std::byte *data, std::size_t size)
 {
-    throw std::logic_error { "codec::ImageSignCodec does not support this operation" };
+    if (data == nullptr)
+        throw std::invalid_argument { "Parameter data must not be nullptr but it seems to be." };
+
+    jpeg_.assign(data, data + size);
 }
 
-void ImageSignCodec::execute()
+void ImageSignCodec::setStreamPaths(std::string srcPath, std::string outPath)
 {
-    encoded_ = buffer_;
-    int col = encoded_.width() / 8 + (encoded_.width() % 8 == 0 ? 0 : 1);
-    int row = encoded_.height() / 8 + (encoded_.height() % 8 == 0 ? 0 : 1);
-
-    signingReceipt_ = buildSignatureText();
-    /*auto itrSignature = signingReceipt_.begin();
-    if (signingReceipt_.size() >= (static_cast<std::size_t>(col) * row) * 4 * 8)
-        throw std::length_error { "Image not large enough to hold the signature." };
+    if (srcPath.empty() || outPath.empty())
+        throw std::invalid_argument { "Parameter srcPath and outPath must not be empty." };
 
-    for (auto grpY : boost::irange(row)) {
-        for (auto grpX : boost::irange(col)) {
-            if (itrSignature == signingReceipt_.end()) return;
-
-            std::vector<std::vector<float>> block;
-            block.resize(8);
-            for (auto &&itr : block) itr.resize(8);
-
-            for (auto itrJ = block.begin(); itrJ != block.end(); itrJ++) {
-                for (auto itrI = itrJ->begin(); itrI != itrJ->end(); itrI++) {
-                    QPoint pos { static_cast<int>(std::distance(itrJ->begin(), itrI) * grpX),
-                                 static_cast<int>(std::distance(block.begin(), itrJ) * grpY) };
-                    auto pixColor = encoded_.pixelColor(pos);
-
-                    if (pixColor.isValid()) {
-                        *itrI = pixColor.blueF();
-                        continue;
-                    }
-
-                    *itrI = 0;
-                }
-            }
-
-            utils::DCT dct;
-            auto dctedBlock = dct.transfrom(block);
-            auto prevBlock = block;
-            std::bitset<8> bufSignatureBits {};
-            unsigned short bitsRemain { 0 };
-            std::array<std::array<int, 2>, 4> posMidFreqCoefficients {
-                { { 1, 4 }, { 2, 3 }, { 3, 2 }, { 4, 1 } }
-            };
-            for (auto idx : boost::irange(4)) {
-                if (bitsRemain == 0) {
-                    if (itrSignature == signingReceipt_.end()) break;
-
-                    auto next = static_cast<std::uint8_t>(*itrSignature);
-                    bufSignatureBits = { *reinterpret_cast<std::uint8_t *>(&next) };
-                    bitsRemain = 8;
-                    itrSignature++;
-                }
-
-                auto &&[posX, posY] = posMidFreqCoefficients[idx];
-                auto &selectedCoefficient = dctedBlock[posY][posX];
-                selectedCoefficient = bufSignatureBits.test(8 - bitsRemain) ? 255.f : 0.f;
-                bitsRemain--;
-            }
+    streamSrcPath_ = std::move(srcPath);
+    streamOutPath_ = std::move(outPath);
+}
 
-            block = dct.itransform(dctedBlock);
-            assert(block != prevBlock);
+void ImageSignCodec::setImage(QImage &&image)
+{
+    buffer_ = std::move(image);
+}
 
-            for (auto itrJ = block.begin(); itrJ != block.end(); itrJ++) {
-                for (auto itrI = itrJ->begin(); itrI != itrJ->end(); itrI++) {
-                    QPoint pos { static_cast<int>(std::distance(itrJ->begin(), itrI) * grpX),
-                                 static_cast<int>(std::distance(block.begin(), itrJ) * grpY) };
-                    auto pixColor = encoded_.pixelColor(pos);
+void ImageSignCodec::setFingerprintSize(std::size_t size)
+{
+    if (size != 0 && size != SignaturePayload::shortFingerprintSize
+        && size != SignaturePayload::fullFingerprintSize)
+        throw std::invalid_argument { "Parameter size is not the size of a fingerprint." };
 
-                    if (pixColor.isValid()) pixColor.setBlueF(std::roundf(*itrI));
-                    encoded_.setPixelColor(pos, pixColor);
-                }
-            }
+    fingerprintSize_ = size;
+}
 
-            auto rawProgress = static_cast<float>(std::distance(signingReceipt_.begin(), itrSignature))
-                    / static_cast<float>(signingReceipt_.size());
-            auto percentProgress = rawProgress * 100.f;
-            emit progressUpdated(percentProgress);
-        }
-    }*/
+void ImageSignCodec::execute()
+{
+    signingReceipt_ = buildSignatureText();
+    const auto watermark = buildWatermark();
+
+    if (!streamSrcPath_.empty())
+        embedIntoStream(watermark);
+    else if (jpeg_.empty())
+        embedIntoPixels(watermark);
+    else
+        embedIntoCoefficients(watermark);
 }
 
 const std::vector<std::byte> &ImageSignCodec::getCodecResult() const
 {
-    throw std::logic_error { "codec::ImageSignCodec does not support this operation" };
+    return encodedJPEG_;
+}
+
+void ImageSignCodec::cancel()
+{
+    cancelled_ = true;
 }
 
 std::vector<std::byte> ImageSignCodec::buildSignatureText()
 {
-    std::vector<std::byte> dataBuffer;
     std::unique_ptr<codec::ICodecFactory> facCodec {
         std::make_unique<codec::DefaultCodecFactory>()
     };
 
-    std::string dmpPbKey;
     auto pbKey = dynamic_cast<const key_generator::PublicRSACryptoKeyGenerator *>(pbKey_);
-    pbKey->getPublicKey().DEREncode(CryptoPP::StringSink { dmpPbKey });
-    BOOST_ASSERT(dmpPbKey.length() < std::numeric_limits<std::uint16_t>::max());
-
-    auto szData = static_cast<std::uint16_t>(dmpPbKey.length());
-    dataBuffer.reserve(sizeof(szData) + dmpPbKey.length());
-    for (auto idx : boost::irange(sizeof(std::uint16_t)))
-        dataBuffer.push_back(reinterpret_cast<const std::byte *>(&szData)[idx]);
-    std::transform(dmpPbKey.begin(), dmpPbKey.end(), std::back_inserter(dataBuffer),
-                   [](const auto &elm) { return static_cast<std::byte>(elm); });
-
-    BOOST_ASSERT(dataBuffer.size() == dataBuffer.capacity());
-
-    szData = static_cast<decltype(szData)>(author_->authorName.length());
-    BOOST_ASSERT(szData < std::numeric_limits<decltype(szData)>::max());
-    dataBuffer.reserve(dataBuffer.size() + sizeof(szData) + szData);
-    for (auto idx : boost::irange(sizeof(szData)))
-        dataBuffer.emplace_back(reinterpret_cast<const std::byte *>(&szData)[idx]);
-    std::transform(author_->authorName.begin(), author_->authorName.end(),
-                   std::back_inserter(dataBuffer),
-                   [](const auto &elm) { return static_cast<std::byte>(elm); });
-
-    BOOST_ASSERT(dataBuffer.size() == dataBuffer.capacity());
-
-    szData = static_cast<decltype(szData)>(author_->authorEmail.length());
-    BOOST_ASSERT(szData < std::numeric_limits<decltype(szData)>::max());
-    dataBuffer.reserve(dataBuffer.size() + sizeof(szData) + szData);
-    for (auto idx : boost::irange(sizeof(szData)))
-        dataBuffer.emplace_back(reinterpret_cast<const std::byte *>(&szData)[idx]);
-    std::transform(author_->authorEmail.begin(), author_->authorEmail.end(),
-                   std::back_inserter(dataBuffer),
-                   [](const auto &elm) { return static_cast<std::byte>(elm); });
-
-    BOOST_ASSERT(dataBuffer.size() == dataBuffer.capacity());
-
-    szData = static_cast<decltype(szData)>(author_->authorPortFolioURL.length());
-    BOOST_ASSERT(szData < std::numeric_limits<decltype(szData)>::max());
-    dataBuffer.reserve(dataBuffer.size() + sizeof(szData) + szData);
-    for (auto idx : boost::irange(sizeof(szData)))
-        dataBuffer.emplace_back(reinterpret_cast<const std::byte *>(&szData)[idx]);
-    std::transform(author_->authorPortFolioURL.begin(), author_->authorPortFolioURL.end(),
-                   std::back_inserter(dataBuffer),
-                   [](const auto &elm) { return static_cast<std::byte>(elm); });
+    const auto publicKey = pbKey->getPublicKey();
+    const auto &modulus = publicKey.GetModulus();
+    const auto &exponent = publicKey.GetPublicExponent();
+
+    SignaturePayload::Fields fields;
+    fields.authorName = author_->authorName;
+    fields.authorEmail = author_->authorEmail;
+    fields.authorPortFolioURL = author_->authorPortFolioURL;
+
+    std::string dmpModulus;
+    std::string dmpExponent;
+    std::string fingerprint;
+    if (fingerprintSize_ != 0) {
+        std::string dmpPbKey;
+        CryptoPP::StringSink pbKeySerializer { dmpPbKey };
+        publicKey.DEREncode(pbKeySerializer);
+        fingerprint = SignaturePayload::fingerprint(dmpPbKey, fingerprintSize_);
+        fields.keyFormat = SignaturePayload::KeyFormat::Fingerprint;
+        fields.fingerprint = fingerprint;
+    } else {
+        dmpModulus.resize(modulus.MinEncodedSize());
+        modulus.Encode(reinterpret_cast<CryptoPP::byte *>(dmpModulus.data()), dmpModulus.size());
+        dmpExponent.resize(exponent.MinEncodedSize());
+        exponent.Encode(reinterpret_cast<CryptoPP::byte *>(dmpExponent.data()),
+                        dmpExponent.size());
+        fields.modulus = dmpModulus;
+        fields.exponent = dmpExponent;
+    }
 
-    BOOST_ASSERT(dataBuffer.size() == dataBuffer.capacity());
+    // A PKCS #1 v1.5 signature is exactly as long as the modulus.
+    auto dataBuffer = SignaturePayload::writeSigned(fields, modulus.ByteCount());
 
     auto signer = facCodec->createDefaultASymCryptoEncryptor(
             dataBuffer, const_cast<key_generator::ICryptoKeyGenerator *>(prKey_));
     signer->execute();
-    auto &&result = signer->getCodecResult();
-    BOOST_ASSERT(result.size() <= std::numeric_limits<std::uint16_t>::max());
-    szData = static_cast<std::uint16_t>(result.size());
-    dataBuffer.reserve(dataBuffer.size() + sizeof(std::uint16_t) + result.size());
-    for (auto idx : boost::irange(sizeof(szData)))
-        dataBuffer.emplace_back(reinterpret_cast<const std::byte *>(&szData)[idx]);
-    std::transform(result.begin(), result.end(), std::back_inserter(dataBuffer),
-                   [](const auto &elm) { return static_cast<std::byte>(elm); });
+    const auto &result = signer->getCodecResult();
+    SignaturePayload::appendSignature(dataBuffer, result.data(), result.size());
 
     BOOST_ASSERT(dataBuffer.size() == dataBuffer.capacity());
 
@@ -222,14 +179,261 @@ std::vector<std::byte> ImageSignCodec::buildSignatureText()
 #endif // DEBUG
 
     return dataBuffer;
-    auto compressCodec = facCodec->createDefaultCompresssCoder(std::move(dataBuffer));
-    compressCodec->execute();
-    //return compressCodec->getCodecResult();
+}
+
+std::vector<std::byte> ImageSignCodec::buildWatermark() const
+{
+    using Layout = WatermarkLayout;
+
+    std::unique_ptr<codec::ICodecFactory> facCodec {
+        std::make_unique<codec::DefaultCodecFactory>()
+    };
+    auto compressCoder = facCodec->createDefaultCompresssCoder(signingReceipt_);
+    compressCoder->execute();
+    const auto &compressed = compressCoder->getCodecResult();
+    BOOST_ASSERT(compressed.size() <= std::numeric_limits<std::uint32_t>::max());
+
+    std::vector<std::byte> watermark;
+    watermark.reserve(Layout::headerSize + compressed.size());
+    for (auto elm : Layout::magic) watermark.push_back(static_cast<std::byte>(elm));
+    watermark.push_back(static_cast<std::byte>(Layout::version));
+    const auto szPayload = static_cast<std::uint32_t>(compressed.size());
+    for (auto idx : boost::irange(Layout::lengthSize))
+        watermark.push_back(static_cast<std::byte>((szPayload >> (idx * 8)) & 0xffu));
+    watermark.insert(watermark.end(), compressed.begin(), compressed.end());
+    return watermark;
+}
+
+void ImageSignCodec::embedIntoPixels(const std::vector<std::byte> &watermark)
+{
+    using Layout = WatermarkLayout;
+    constexpr int szBlock { Layout::blockSize };
+
+    // Moving the image out let Qt convert it in place, and bits() below find it not shared.
+    encoded_ = std::move(buffer_).convertToFormat(QImage::Format_ARGB32);
+    const std::size_t szBits { watermark.size() * 8 };
+    if (szBits > Layout::capacity(encoded_.width(), encoded_.height()))
+        throw std::length_error { "Image not large enough to hold the signature." };
+
+    const int col { encoded_.width() / szBlock };
+    const std::size_t szBlocks { (szBits + Layout::bitsPerBlock - 1) / Layout::bitsPerBlock };
+    // Detach once here, scanLine() of a shared image is not safe to call from the workers.
+    uchar *pixels { encoded_.bits() };
+    const auto bytesPerLine = static_cast<std::ptrdiff_t>(encoded_.bytesPerLine());
+
+    embedInBands(col, szBlocks, [&](int grpX, int grpY, std::size_t idxBlock) {
+        auto origin = pixels + grpY * szBlock * bytesPerLine
+                + static_cast<std::ptrdiff_t>(grpX * szBlock * sizeof(QRgb));
+        signBlock(origin, bytesPerLine, bitsOfBlock(watermark, idxBlock));
+    });
+}
+
+void ImageSignCodec::embedIntoStream(const std::vector<std::byte> &watermark)
+{
+    using Layout = WatermarkLayout;
+    using Clock = std::chrono::steady_clock;
+    constexpr int szBlock { Layout::blockSize };
+
+    utils::JPEGStripTranscoder transcoder { streamSrcPath_ };
+    const std::size_t szBits { watermark.size() * 8 };
+    if (szBits > Layout::capacity(transcoder.width(), transcoder.height()))
+        throw std::length_error { "Image not large enough to hold the signature." };
+
+    const int col { transcoder.width() / szBlock };
+    const std::size_t szBlocks { (szBits + Layout::bitsPerBlock - 1) / Layout::bitsPerBlock };
+    const auto height = static_cast<float>(transcoder.height());
+    auto lastReport = Clock::now();
+
+    // The watermark only covers the first strips, later strips pass through untouched.
+    auto signStrip = [&](uchar *strip, std::ptrdiff_t bytesPerLine, int firstRow, int rows) {
+        if (cancelled_) throw std::runtime_error { "Signing cancelled." };
+
+        // Strips are whole block rows, an incomplete block row at the bottom is never signed.
+        for (int y = 0; y + szBlock <= rows; y += szBlock) {
+            const std::size_t begBlock { static_cast<std::size_t>((firstRow + y) / szBlock) * col };
+            if (begBlock >= szBlocks) break;
+
+            for (auto idxBlock : boost::irange(begBlock, std::min(begBlock + col, szBlocks))) {
+                const auto offsetX = (idxBlock - begBlock) * szBlock * sizeof(QRgb);
+                auto origin = strip + y * bytesPerLine + static_cast<std::ptrdiff_t>(offsetX);
+                signBlock(origin, bytesPerLine, bitsOfBlock(watermark, idxBlock));
+            }
+        }
+
+        const auto now = Clock::now();
+        if (now - lastReport >= progressInterval) {
+            lastReport = now;
+            emit progressUpdated(static_cast<float>(firstRow + rows) / height * 100.f);
+        }
+    };
+    transcoder.transcode(streamOutPath_, signStrip);
+
+    emit progressUpdated(100.f);
+}
+
+void ImageSignCodec::embedIntoCoefficients(const std::vector<std::byte> &watermark)
+{
+    using Layout = WatermarkLayout;
+    constexpr int szCoefficients { Layout::blockSize * Layout::blockSize };
+
+    utils::JPEGCoefficients coefficients { jpeg_ };
+    const int col { coefficients.blockColumns() };
+    const std::size_t szBits { watermark.size() * 8 };
+    const std::size_t szBlocks { (szBits + Layout::bitsPerBlock - 1) / Layout::bitsPerBlock };
+    if (szBlocks > static_cast<std::size_t>(col) * coefficients.blockRows())
+        throw std::length_error { "Image not large enough to hold the signature." };
+
+    // libjpeg is not thread safe, resolve the block rows here and let the workers only index them.
+    const int row { static_cast<int>((szBlocks + col - 1) / col) };
+    std::vector<std::int16_t *> blockRows;
+    blockRows.reserve(static_cast<std::size_t>(row));
+    for (auto grpY : boost::irange(row)) blockRows.push_back(coefficients.block(0, grpY));
+
+    embedInBands(col, szBlocks, [&](int grpX, int grpY, std::size_t idxBlock) {
+        const auto bits = bitsOfBlock(watermark, idxBlock);
+        auto block = blockRows[grpY] + grpX * szCoefficients;
+        for (auto idx : boost::irange(Layout::bitsPerBlock)) {
+            const auto &[posX, posY] = Layout::positions[idx];
+            auto &coefficient = block[posY * Layout::blockSize + posX];
+            // Step toward zero to flip the parity, a zero coefficient becomes 1. Most carriers are
+            // zero once quantized, skipping them would leave too few for the signature, and the
+            // coefficients made non-zero only grow the file by about a percent.
+            if (Layout::bitOfQuantized(coefficient) != bits[idx])
+                coefficient = static_cast<std::int16_t>(coefficient + (coefficient > 0 ? -1 : 1));
+        }
+    });
+
+    encodedJPEG_ = coefficients.save();
+}
+
+void ImageSignCodec::embedInBands(int col, std::size_t szBlocks,
+                                  const std::function<void(int, int, std::size_t)> &embed)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto &pool = utils::ThreadPool::getInstance();
+    const int row { static_cast<int>((szBlocks + col - 1) / col) };
+    const int bands { std::min(row, static_cast<int>(pool.threadCount()) * bandsPerWorker) };
+    const auto begTime = Clock::now();
+    const auto interval = std::chrono::duration_cast<Clock::duration>(progressInterval).count();
+    std::atomic<std::size_t> szEmbedded { 0 };
+    std::atomic<Clock::rep> lastReport { 0 };
+
+    pool.parallelFor(static_cast<std::size_t>(bands), [&](std::size_t band) {
+        const int firstRow { static_cast<int>(band * row / bands) };
+        const int lastRow { static_cast<int>((band + 1) * row / bands) };
+        for (int grpY = firstRow; grpY < lastRow; grpY++) {
+            if (cancelled_) return;
+
+            const std::size_t begBlock { static_cast<std::size_t>(grpY) * col };
+            const std::size_t endBlock { std::min(begBlock + col, szBlocks) };
+            for (auto idxBlock : boost::irange(begBlock, endBlock))
+                embed(static_cast<int>(idxBlock - begBlock), grpY, idxBlock);
+            szEmbedded.fetch_add(endBlock - begBlock);
+
+            // Only the worker which moves the report time forward emits, the others keep working.
+            const auto now = (Clock::now() - begTime).count();
+            auto last = lastReport.load();
+            if (now - last >= interval && lastReport.compare_exchange_strong(last, now)) {
+                emit progressUpdated(static_cast<float>(szEmbedded.load())
+                                     / static_cast<float>(szBlocks) * 100.f);
+            }
+        }
+    });
+
+    if (cancelled_) throw std::runtime_error { "Signing cancelled." };
+    emit progressUpdated(100.f);
+}
+
+std::array<bool, WatermarkLayout::bitsPerBlock>
+ImageSignCodec::bitsOfBlock(const std::vector<std::byte> &watermark, std::size_t idxBlock)
+{
+    std::array<bool, WatermarkLayout::bitsPerBlock> bits {};
+    for (auto idx : boost::irange(bits.size())) {
+        const std::size_t idxBit { idxBlock * WatermarkLayout::bitsPerBlock + idx };
+        if (idxBit / 8 < watermark.size())
+            bits[idx] = (static_cast<std::uint8_t>(watermark[idxBit / 8]) >> (idxBit % 8)) & 1u;
+    }
+    return bits;
+}
+
+void ImageSignCodec::signBlock(uchar *origin, std::ptrdiff_t bytesPerLine,
+                               const std::array<bool, WatermarkLayout::bitsPerBlock> &bits)
+{
+    // Saturated blocks are pulled away from 0 and 255 once, then embedding never clamps.
+    if (!embedBlock(origin, bytesPerLine, bits)) {
+        compressBlockRange(origin, bytesPerLine);
+        embedBlock(origin, bytesPerLine, bits);
+    }
+}
+
+bool ImageSignCodec::embedBlock(uchar *origin, std::ptrdiff_t bytesPerLine,
+                                const std::array<bool, WatermarkLayout::bitsPerBlock> &bits)
+{
+    using Layout = WatermarkLayout;
+    constexpr int szBlock { Layout::blockSize };
+
+    utils::BlockDCT dct;
+    utils::BlockDCT::Block samples;
+    for (int y = 0; y < szBlock; y++) {
+        auto line = reinterpret_cast<const QRgb *>(origin + y * bytesPerLine);
+        for (int x = 0; x < szBlock; x++) samples[y * szBlock + x] = Layout::luma(line[x]);
+    }
+
+    utils::BlockDCT::Block coefficients;
+    dct.transform(samples, coefficients);
+
+    utils::BlockDCT::Block delta {};
+    for (std::size_t idx = 0; idx < Layout::bitsPerBlock; idx++) {
+        const auto &[posX, posY] = Layout::positions[idx];
+        const float coefficient { coefficients[posY * szBlock + posX] };
+        auto level = std::lround(coefficient / Layout::step);
+        if (((level & 1) != 0) != bits[idx])
+            level += coefficient > static_cast<float>(level) * Layout::step ? 1 : -1;
+        delta[posY * szBlock + posX] = static_cast<float>(level) * Layout::step - coefficient;
+    }
+
+    utils::BlockDCT::Block shift;
+    dct.itransform(delta, shift);
+
+    bool inRange { true };
+    for (int y = 0; y < szBlock; y++) {
+        auto line = reinterpret_cast<QRgb *>(origin + y * bytesPerLine);
+        for (int x = 0; x < szBlock; x++) {
+            const float offset { shift[y * szBlock + x] };
+            auto apply = [&](int value) {
+                const auto shifted =
+                        static_cast<int>(std::lround(static_cast<float>(value) + offset));
+                if (shifted < 0 || shifted > 255) inRange = false;
+                return std::clamp(shifted, 0, 255);
+            };
+            line[x] = qRgba(apply(qRed(line[x])), apply(qGreen(line[x])), apply(qBlue(line[x])),
+                            qAlpha(line[x]));
+        }
+    }
+    return inRange;
+}
+
+void ImageSignCodec::compressBlockRange(uchar *origin, std::ptrdiff_t bytesPerLine)
+{
+    using Layout = WatermarkLayout;
+    constexpr int szBlock { Layout::blockSize };
+    constexpr float scale { static_cast<float>(255 - 2 * Layout::margin) / 255.f };
+    auto compress = [](int value) {
+        return Layout::margin + static_cast<int>(std::lround(static_cast<float>(value) * scale));
+    };
+
+    for (int y = 0; y < szBlock; y++) {
+        auto line = reinterpret_cast<QRgb *>(origin + y * bytesPerLine);
+        for (int x = 0; x < szBlock; x++)
+            line[x] = qRgba(compress(qRed(line[x])), compress(qGreen(line[x])),
+                            compress(qBlue(line[x])), qAlpha(line[x]));
+    }
 }
 
 QImage ImageSignCodec::getEncodedImage()
 {
-    return encoded_;
+    return std::move(encoded_);
 }
 
 std::string ImageSignCodec::getSigningReceipt()
@@ -0,0 +1,160 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace codec {
+/**
+ * @brief Binary layout of the signature payload, which is compressed and embedded into images.
+ *
+ * The payload opens with version and the format of the key, followed by the key of the author, the name,
+ * email and portfolio URL of the author, then the RSA signature of every byte before it. The key is either
+ * the modulus and public exponent of the RSA key as big endian integers, or its fingerprint which the
+ * verifier resolve against the keys it trusts. Every field is prefixed by its length as an unsigned LEB128
+ * varint, so a field shorter than 128 bytes costs a single byte of length.
+ *
+ * The whole payload is sized up front and written in a single allocation. Reading does not copy, every
+ * field is a view into the payload.
+ */
+class SignaturePayload
+{
+public:
+    /**
+     * @brief Version of the layout, written first.
+     */
+    static constexpr std::uint8_t version { 3 };
+    /**
+     * @brief Largest size in bytes of a varint length.
+     */
+    static constexpr std::size_t maxVarintSize { (sizeof(std::size_t) * 8 + 6) / 7 };
+
+    /**
+     * @brief Size in bytes of a short fingerprint.
+     */
+    static constexpr std::size_t shortFingerprintSize { 16 };
+    /**
+     * @brief Size in bytes of a full fingerprint.
+     */
+    static constexpr std::size_t fullFingerprintSize { 32 };
+
+    /**
+     * @brief Format of the key of the author, written after version.
+     */
+    enum class KeyFormat : std::uint8_t {
+        PublicKey = 0, /**< Modulus and public exponent of the key. */
+        Fingerprint = 1 /**< Fingerprint of the key. */
+    };
+
+    /**
+     * @brief Fields covered by the signature, in layout order.
+     */
+    struct Fields
+    {
+        /**
+         * @brief Format of the key, determine which of the key fields are written.
+         */
+        KeyFormat keyFormat { KeyFormat::PublicKey };
+        /**
+         * @brief Modulus of the RSA key, big endian, written with KeyFormat::PublicKey.
+         */
+        std::string_view modulus;
+        /**
+         * @brief Public exponent of the RSA key, big endian, written with KeyFormat::PublicKey.
+         */
+        std::string_view exponent;
+        /**
+         * @brief Fingerprint of the RSA key, written with KeyFormat::Fingerprint.
+         */
+        std::string_view fingerprint;
+        /**
+         * @brief Name of the author.
+         */
+        std::string_view authorName;
+        /**
+         * @brief Email of the author.
+         */
+        std::string_view authorEmail;
+        /**
+         * @brief Portfolio URL of the author.
+         */
+        std::string_view authorPortFolioURL;
+    };
+
+    /**
+     * @brief Compute fingerprint of a public key, the leading bytes of the SHA3-256 of its DER encoding.
+     * @param derPublicKey DER encoded public key.
+     * @param size Size of the fingerprint, shortFingerprintSize or fullFingerprintSize.
+     * @return Fingerprint of the key.
+     * @throw std::invalid_argument if @p size is not a fingerprint size.
+     */
+    static std::string fingerprint(std::string_view derPublicKey, std::size_t size);
+    /**
+     * @brief Get size of a payload.
+     * @param fields Fields of the payload.
+     * @param szSignature Size of the signature.
+     * @return Size in bytes.
+     */
+    static std::size_t size(const Fields &fields, std::size_t szSignature);
+    /**
+     * @brief Write the signed part of a payload, into a buffer reserved for the whole payload.
+     * @param fields Fields of the payload.
+     * @param szSignature Size of the signature appended later with appendSignature.
+     * @return Signed part of the payload.
+     * @throw std::invalid_argument if the fingerprint is not of a fingerprint size.
+     */
+    static std::vector<std::byte> writeSigned(const Fields &fields, std::size_t szSignature);
+    /**
+     * @brief Append signature of the signed part to a payload built by writeSigned.
+     * @param payload Payload to append to.
+     * @param signature Signature of @p payload.
+     * @param szSignature Size of the signature.
+     * @throw std::length_error if the signature is larger than the size given to writeSigned.
+     */
+    static void appendSignature(std::vector<std::byte> &payload, const std::byte *signature,
+                                std::size_t szSignature);
+
+    /**
+     * @brief Parse payload, nothing is copied so @p data must outlive the payload.
+     * @param data Payload.
+     * @param size Size of the payload.
+     * @throw std::runtime_error if the payload is truncated, has trailing bytes, is of another version, or
+     * has an unknown key format.
+     */
+    SignaturePayload(const std::byte *data, std::size_t size);
+
+public: // Accessors
+    /**
+     * @brief Get fields covered by the signature.
+     */
+    const Fields &fields() const;
+    /**
+     * @brief Get bytes covered by the signature.
+     */
+    std::string_view signedData() const;
+    /**
+     * @brief Get signature of signedData().
+     */
+    std::string_view signature() const;
+
+private:
+    /**
+     * @brief Fields covered by the signature.
+     */
+    Fields fields_;
+    /**
+     * @brief Bytes covered by the signature.
+     */
+    std::string_view signedData_;
+    /**
+     * @brief Signature of @p signedData_.
+     */
+    std::string_view signature_;
+};
+}
@@ -0,0 +1,116 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QImage>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace codec {
+/**
+ * @brief Layout of the signature watermark embedded into images.
+ *
+ * The watermark is carried by the luminance of every 8x8 block, in block row major order. Each
+ * block hold a bit in each of the mid-frequency coefficients listed in positions, bytes are written
+ * least significant bit first. The payload is preceded by a header of magic, version and payload
+ * length, so a reader could reject an image after a few blocks and stop once the payload is read.
+ *
+ * The watermark is written in one of two domains:
+ * - Pixels, only complete blocks are used. A bit is embedded by moving the coefficient to the
+ *   nearest multiple of step whose parity equal to the bit, so the bit survive rounding of the
+ *   samples and a high quality JPEG encode. Red, green and blue are shifted by the same amount,
+ *   which leave the chrominance untouched.
+ * - Quantized coefficients of a JPEG file, every luminance block stored in the file is used. A bit
+ *   is the parity of the quantized coefficient, the file is written back without decoding so
+ *   nothing else change.
+ */
+struct WatermarkLayout
+{
+    /**
+     * @brief Width and height of a block.
+     */
+    static constexpr int blockSize { 8 };
+    /**
+     * @brief Coefficients which carry the bits of a block, as (x, y) pairs.
+     */
+    static constexpr std::array<std::array<int, 2>, 4> positions {
+        { { 1, 4 }, { 2, 3 }, { 3, 2 }, { 4, 1 } }
+    };
+    /**
+     * @brief Amount of bits carried by a block.
+     */
+    static constexpr std::size_t bitsPerBlock { positions.size() };
+    /**
+     * @brief Quantization step of a carrying coefficient.
+     */
+    static constexpr float step { 16.f };
+    /**
+     * @brief Largest change of a sample caused by embedding a block.
+     *
+     * A coefficient moves at most one step and no mid-frequency basis function exceed 1 / 4, samples
+     * kept this far away from 0 and 255 never get clamped.
+     */
+    static constexpr int margin { static_cast<int>(step) * static_cast<int>(bitsPerBlock) / 4 };
+    /**
+     * @brief Bytes which open the header, tell a signed image apart from an unsigned one.
+     */
+    static constexpr std::array<std::uint8_t, 4> magic { { 'A', 'D', 'S', 'I' } };
+    /**
+     * @brief Version of the layout, written after magic.
+     */
+    static constexpr std::uint8_t version { 1 };
+    /**
+     * @brief Size in bytes of the little endian payload length, written after version.
+     */
+    static constexpr std::size_t lengthSize { 4 };
+    /**
+     * @brief Size in bytes of the header written before the payload.
+     */
+    static constexpr std::size_t headerSize { magic.size() + sizeof(version) + lengthSize };
+
+    /**
+     * @brief Get amount of bits an image could carry.
+     * @param width Width of the image.
+     * @param height Height of the image.
+     * @return Amount of bits.
+     */
+    static std::size_t capacity(int width, int height)
+    {
+        return static_cast<std::size_t>(width / blockSize)
+                * static_cast<std::size_t>(height / blockSize) * bitsPerBlock;
+    }
+    /**
+     * @brief Get luminance of a pixel.
+     * @param pixel Pixel in QImage::Format_ARGB32.
+     * @return Luminance in [0, 255].
+     */
+    static float luma(QRgb pixel)
+    {
+        return 0.299f * static_cast<float>(qRed(pixel)) + 0.587f * static_cast<float>(qGreen(pixel))
+                + 0.114f * static_cast<float>(qBlue(pixel));
+    }
+    /**
+     * @brief Get bit carried by a coefficient.
+     * @param coefficient Coefficient at one of positions.
+     * @return Bit carried.
+     */
+    static bool bitOf(float coefficient)
+    {
+        return (std::lround(coefficient / step) & 1) != 0;
+    }
+    /**
+     * @brief Get bit carried by a quantized coefficient of a JPEG file.
+     * @param coefficient Quantized coefficient at one of positions.
+     * @return Bit carried.
+     */
+    static bool bitOfQuantized(std::int16_t coefficient)
+    {
+        return (coefficient & 1) != 0;
+    }
+};
+}
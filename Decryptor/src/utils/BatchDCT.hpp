@@ -0,0 +1,141 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "utils/BlockDCT.hpp"
+
+namespace utils {
+/**
+ * @brief Vectorized 8x8 DCT engine which transform 8 blocks at a time.
+ *
+ * Blocks of a batch are interleaved across vector lanes, sample k of block b is located at
+ * [k * batchSize + b], so each arithmetic instruction process the same sample of all 8 blocks. The
+ * kernel is chosen at runtime from the instruction sets supported by the CPU, the scalar kernel is used
+ * when none of them are available and produce the same result as utils::BlockDCT within rounding error.
+ */
+class BatchDCT
+{
+public:
+    /**
+     * @brief Amount of blocks transformed at a time.
+     */
+    static constexpr std::size_t batchSize { 8 };
+    /**
+     * @brief Interleaved samples or coefficients of a batch of blocks.
+     */
+    using Batch = std::array<float, BlockDCT::blockArea * batchSize>;
+    /**
+     * @brief Kernel implementations.
+     */
+    enum class Backend {
+        Scalar, /**< Portable scalar kernel. */
+        SSE2, /**< 128 bit SSE2 kernel. */
+        AVX2, /**< 256 bit AVX2 and FMA3 kernel. */
+        AVX512 /**< 512 bit AVX-512 kernel. */
+    };
+
+public:
+    /**
+     * @brief Create transform with the fastest kernel supported by the CPU.
+     */
+    BatchDCT();
+    /**
+     * @brief Create transform with specific kernel.
+     * @param backend Kernel to use.
+     * @throw std::invalid_argument if @p backend is not supported by the CPU.
+     */
+    explicit BatchDCT(Backend backend);
+
+    /**
+     * @brief Get the fastest kernel supported by the CPU.
+     * @return Fastest kernel available.
+     */
+    static Backend detectBackend();
+    /**
+     * @brief Determine if @p backend could run on the CPU.
+     * @param backend Kernel to check.
+     * @return True if @p backend is supported.
+     */
+    static bool isSupported(Backend backend);
+    /**
+     * @brief Get name of @p backend.
+     * @param backend Kernel to name.
+     * @return Human readable name of @p backend.
+     */
+    static std::string_view nameOf(Backend backend);
+    /**
+     * @brief Interleave 8 blocks into a batch.
+     * @param blocks First of 8 contiguous blocks.
+     * @param batch Batch to write.
+     */
+    static void interleave(const BlockDCT::Block *blocks, Batch &batch);
+    /**
+     * @brief Deinterleave a batch into 8 blocks.
+     * @param batch Batch to read.
+     * @param blocks First of 8 contiguous blocks to write.
+     */
+    static void deinterleave(const Batch &batch, BlockDCT::Block *blocks);
+
+    /**
+     * @brief Transform batch of samples into DCT coefficients.
+     * @param input Interleaved samples.
+     * @param output Interleaved coefficients, may refer to @p input.
+     */
+    void transform(const Batch &input, Batch &output) const;
+    /**
+     * @brief Transform batch of DCT coefficients back into samples.
+     * @param input Interleaved coefficients.
+     * @param output Interleaved samples, may refer to @p input.
+     */
+    void itransform(const Batch &input, Batch &output) const;
+    /**
+     * @brief Transform contiguous blocks in place, 8 blocks at a time.
+     *
+     * Remaining blocks that could not fill a batch are transformed with utils::BlockDCT.
+     *
+     * @param blocks First block to transform.
+     * @param count Amount of blocks.
+     */
+    void transformBlocks(BlockDCT::Block *blocks, std::size_t count) const;
+    /**
+     * @brief Inverse transform contiguous blocks in place, 8 blocks at a time.
+     * @param blocks First block to transform.
+     * @param count Amount of blocks.
+     *
+     * @sa transformBlocks(BlockDCT::Block *, std::size_t)
+     */
+    void itransformBlocks(BlockDCT::Block *blocks, std::size_t count) const;
+
+public: // Accessors
+    /**
+     * @brief Get kernel used by the transform.
+     */
+    Backend backend() const;
+
+private:
+    /**
+     * @brief Signature of kernels, which take basis table, input batch and output batch.
+     */
+    using Kernel = void (*)(const float *, const float *, float *);
+
+private:
+    /**
+     * @brief Kernel used by the transform.
+     */
+    Backend backend_ { Backend::Scalar };
+    /**
+     * @brief Forward kernel.
+     */
+    Kernel forward_ { nullptr };
+    /**
+     * @brief Inverse kernel.
+     */
+    Kernel inverse_ { nullptr };
+};
+}
@@ -0,0 +1,117 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <cstddef>
+
+#include "utils/CPUFeatures.hpp"
+
+/**
+ * @brief Kernels of utils::BatchDCT, internal use only.
+ *
+ * Each instruction set lives in its own translation unit which compiled with the matching compiler flags,
+ * they must only be called after the CPU reported support of that instruction set.
+ */
+namespace utils::batch_dct {
+/**
+ * @brief Width and height of a block.
+ */
+constexpr std::size_t blockSize { 8 };
+/**
+ * @brief Amount of blocks interleaved in a batch.
+ */
+constexpr std::size_t lanes { 8 };
+
+/**
+ * @brief Separable forward transform over interleaved batch.
+ *
+ * @tparam Ops Vector operations, provides Vec holding one sample of all 8 lanes, load, store, broadcast,
+ * zero and fmadd(a, b, c) = a * b + c.
+ * @param basis Basis table of utils::BlockDCT.
+ * @param input Interleaved samples.
+ * @param output Interleaved coefficients, may alias @p input.
+ */
+template<typename Ops>
+inline void forward(const float *basis, const float *input, float *output)
+{
+    using Vec = typename Ops::Vec;
+    Vec rowPass[blockSize * blockSize];
+    Vec samples[blockSize];
+
+    for (std::size_t y = 0; y < blockSize; y++) {
+        for (std::size_t x = 0; x < blockSize; x++)
+            samples[x] = Ops::load(input + (y * blockSize + x) * lanes);
+
+        for (std::size_t u = 0; u < blockSize; u++) {
+            Vec sum { Ops::zero() };
+            for (std::size_t x = 0; x < blockSize; x++)
+                sum = Ops::fmadd(Ops::broadcast(basis[u * blockSize + x]), samples[x], sum);
+            rowPass[y * blockSize + u] = sum;
+        }
+    }
+
+    for (std::size_t v = 0; v < blockSize; v++) {
+        for (std::size_t u = 0; u < blockSize; u++) {
+            Vec sum { Ops::zero() };
+            for (std::size_t y = 0; y < blockSize; y++)
+                sum = Ops::fmadd(Ops::broadcast(basis[v * blockSize + y]),
+                                 rowPass[y * blockSize + u], sum);
+            Ops::store(output + (v * blockSize + u) * lanes, sum);
+        }
+    }
+}
+
+/**
+ * @brief Separable inverse transform over interleaved batch.
+ *
+ * @tparam Ops Vector operations.
+ * @param basis Basis table of utils::BlockDCT.
+ * @param input Interleaved coefficients.
+ * @param output Interleaved samples, may alias @p input.
+ *
+ * @sa forward(const float *, const float *, float *)
+ */
+template<typename Ops>
+inline void inverse(const float *basis, const float *input, float *output)
+{
+    using Vec = typename Ops::Vec;
+    Vec rowPass[blockSize * blockSize];
+    Vec coefficients[blockSize];
+
+    for (std::size_t v = 0; v < blockSize; v++) {
+        for (std::size_t u = 0; u < blockSize; u++)
+            coefficients[u] = Ops::load(input + (v * blockSize + u) * lanes);
+
+        for (std::size_t x = 0; x < blockSize; x++) {
+            Vec sum { Ops::zero() };
+            for (std::size_t u = 0; u < blockSize; u++)
+                sum = Ops::fmadd(Ops::broadcast(basis[u * blockSize + x]), coefficients[u], sum);
+            rowPass[v * blockSize + x] = sum;
+        }
+    }
+
+    for (std::size_t y = 0; y < blockSize; y++) {
+        for (std::size_t x = 0; x < blockSize; x++) {
+            Vec sum { Ops::zero() };
+            for (std::size_t v = 0; v < blockSize; v++)
+                sum = Ops::fmadd(Ops::broadcast(basis[v * blockSize + y]),
+                                 rowPass[v * blockSize + x], sum);
+            Ops::store(output + (y * blockSize + x) * lanes, sum);
+        }
+    }
+}
+
+void forwardScalar(const float *basis, const float *input, float *output);
+void inverseScalar(const float *basis, const float *input, float *output);
+
+#ifdef ADSI_ARCH_X86
+void forwardSSE2(const float *basis, const float *input, float *output);
+void inverseSSE2(const float *basis, const float *input, float *output);
+void forwardAVX2(const float *basis, const float *input, float *output);
+void inverseAVX2(const float *basis, const float *input, float *output);
+void forwardAVX512(const float *basis, const float *input, float *output);
+void inverseAVX512(const float *basis, const float *input, float *output);
+#endif // ADSI_ARCH_X86
+}
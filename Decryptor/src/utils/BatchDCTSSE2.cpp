@@ -0,0 +1,58 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include "utils/BatchDCTKernel.hpp"
+
+#ifdef ADSI_ARCH_X86
+#    include <emmintrin.h>
+
+namespace utils::batch_dct {
+namespace {
+/**
+ * @brief Vector operations of SSE2 kernel, 8 lanes are held in two 128 bit registers.
+ */
+struct SSE2Ops
+{
+    struct Vec
+    {
+        __m128 low;
+        __m128 high;
+    };
+
+    static Vec load(const float *src) { return { _mm_loadu_ps(src), _mm_loadu_ps(src + 4) }; }
+
+    static void store(float *dst, const Vec &value)
+    {
+        _mm_storeu_ps(dst, value.low);
+        _mm_storeu_ps(dst + 4, value.high);
+    }
+
+    static Vec broadcast(float value)
+    {
+        auto lanes = _mm_set1_ps(value);
+        return { lanes, lanes };
+    }
+
+    static Vec zero() { return { _mm_setzero_ps(), _mm_setzero_ps() }; }
+
+    static Vec fmadd(const Vec &lhs, const Vec &rhs, const Vec &addend)
+    {
+        return { _mm_add_ps(_mm_mul_ps(lhs.low, rhs.low), addend.low),
+                 _mm_add_ps(_mm_mul_ps(lhs.high, rhs.high), addend.high) };
+    }
+};
+}
+
+void forwardSSE2(const float *basis, const float *input, float *output)
+{
+    forward<SSE2Ops>(basis, input, output);
+}
+
+void inverseSSE2(const float *basis, const float *input, float *output)
+{
+    inverse<SSE2Ops>(basis, input, output);
+}
+}
+#endif // ADSI_ARCH_X86
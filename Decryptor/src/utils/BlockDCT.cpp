@@ -0,0 +1,98 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include "utils/BlockDCT.hpp"
+#include "utils/ConstMath.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Orthonormal DCT-II basis, basis[u * N + x] = a(u) * cos((2x + 1) * u * pi / 2N).
+ * @tparam N Width and height of a block.
+ * @return Basis table evaluated at compile time.
+ */
+template<std::size_t N>
+constexpr typename BasicBlockDCT<N>::Block makeBasis()
+{
+    typename BasicBlockDCT<N>::Block table {};
+    for (std::size_t u = 0; u < N; u++) {
+        const double scale { const_math::sqrt((u == 0 ? 1.0 : 2.0) / N) };
+        for (std::size_t x = 0; x < N; x++) {
+            const double angle { (2.0 * x + 1.0) * u * const_math::pi / (2.0 * N) };
+            table[u * N + x] = static_cast<float>(scale * const_math::cos(angle));
+        }
+    }
+    return table;
+}
+
+/**
+ * @brief Basis table shared by every transform of the same size.
+ */
+template<std::size_t N>
+constexpr typename BasicBlockDCT<N>::Block basisTable { makeBasis<N>() };
+}
+
+template<std::size_t N>
+const typename BasicBlockDCT<N>::Block &BasicBlockDCT<N>::basis()
+{
+    return basisTable<N>;
+}
+
+template<std::size_t N>
+void BasicBlockDCT<N>::transform(const Block &input, Block &output) const
+{
+    const auto &table = basisTable<N>;
+    Block rowPass;
+    for (std::size_t y = 0; y < blockSize; y++) {
+        const float *samples { &input[y * blockSize] };
+        for (std::size_t u = 0; u < blockSize; u++) {
+            const float *basis { &table[u * blockSize] };
+            float sum { 0.f };
+            for (std::size_t x = 0; x < blockSize; x++) sum += basis[x] * samples[x];
+            rowPass[y * blockSize + u] = sum;
+        }
+    }
+
+    for (std::size_t v = 0; v < blockSize; v++) {
+        const float *basis { &table[v * blockSize] };
+        for (std::size_t u = 0; u < blockSize; u++) {
+            float sum { 0.f };
+            for (std::size_t y = 0; y < blockSize; y++)
+                sum += basis[y] * rowPass[y * blockSize + u];
+            output[v * blockSize + u] = sum;
+        }
+    }
+}
+
+template<std::size_t N>
+void BasicBlockDCT<N>::itransform(const Block &input, Block &output) const
+{
+    const auto &table = basisTable<N>;
+    Block rowPass;
+    for (std::size_t v = 0; v < blockSize; v++) {
+        const float *coefficients { &input[v * blockSize] };
+        for (std::size_t x = 0; x < blockSize; x++) {
+            float sum { 0.f };
+            for (std::size_t u = 0; u < blockSize; u++)
+                sum += table[u * blockSize + x] * coefficients[u];
+            rowPass[v * blockSize + x] = sum;
+        }
+    }
+
+    for (std::size_t y = 0; y < blockSize; y++) {
+        for (std::size_t x = 0; x < blockSize; x++) {
+            float sum { 0.f };
+            for (std::size_t v = 0; v < blockSize; v++)
+                sum += table[v * blockSize + y] * rowPass[v * blockSize + x];
+            output[y * blockSize + x] = sum;
+        }
+    }
+}
+
+template class BasicBlockDCT<4>;
+template class BasicBlockDCT<8>;
+template class BasicBlockDCT<16>;
+template class BasicBlockDCT<32>;
+}
@@ -0,0 +1,76 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    define ADSI_ARCH_X86
+#endif
+
+namespace utils {
+/**
+ * @brief Singleton object that describe instruction set extensions supported by the running CPU.
+ *
+ * Features are queried from CPUID once, extensions that require OS support of extended registers are
+ * only reported if the OS saves those registers on context switch. Everything is reported as unsupported
+ * on non x86 architectures.
+ */
+class CPUFeatures
+{
+public:
+    CPUFeatures(const CPUFeatures &) = delete;
+    CPUFeatures(CPUFeatures &&) = delete;
+    CPUFeatures &operator=(const CPUFeatures &) = delete;
+    CPUFeatures &operator=(CPUFeatures &&) = delete;
+
+    /**
+     * @brief Get unique instance of CPUFeatures.
+     * @return Unique instance of CPUFeatures.
+     */
+    static const CPUFeatures &getInstance();
+
+public: // Accessors
+    /**
+     * @brief Determine if SSE2 is supported.
+     */
+    bool hasSSE2() const;
+    /**
+     * @brief Determine if POPCNT instruction is supported.
+     */
+    bool hasPOPCNT() const;
+    /**
+     * @brief Determine if both AVX2 and FMA3 are supported.
+     */
+    bool hasAVX2() const;
+    /**
+     * @brief Determine if AVX-512 Foundation is supported.
+     */
+    bool hasAVX512() const;
+
+private:
+    /**
+     * @brief Query features from the CPU, internal use only.
+     */
+    CPUFeatures();
+
+private:
+    /**
+     * @brief SSE2 support.
+     */
+    bool sse2_ { false };
+    /**
+     * @brief POPCNT support.
+     */
+    bool popcnt_ { false };
+    /**
+     * @brief AVX2 and FMA3 support.
+     */
+    bool avx2_ { false };
+    /**
+     * @brief AVX-512 Foundation support.
+     */
+    bool avx512_ { false };
+};
+}
@@ -0,0 +1,93 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <new>
+#include <stdexcept>
+
+#include "utils/CoefficientPlane.hpp"
+
+namespace utils {
+static_assert(sizeof(BlockDCT::Block) == sizeof(float) * BlockDCT::blockArea,
+              "Blocks must be tightly packed to form a contiguous plane.");
+
+CoefficientPlane::CoefficientPlane(int width, int height)
+{
+    resize(width, height);
+}
+
+void CoefficientPlane::resize(int width, int height)
+{
+    if (width < 0 || height < 0)
+        throw std::invalid_argument { "Dimension of coefficient plane must not be negative." };
+
+    constexpr auto blockSize = static_cast<int>(BlockDCT::blockSize);
+    width_ = width;
+    height_ = height;
+    blockColumns_ = (width + blockSize - 1) / blockSize;
+    blockRows_ = (height + blockSize - 1) / blockSize;
+
+    auto required = blockCount();
+    if (required == capacity_) return;
+
+    blocks_ = nullptr;
+    capacity_ = 0;
+    if (required == 0) return;
+
+    auto storage =
+            ::operator new[](required * sizeof(BlockDCT::Block), std::align_val_t { alignment });
+    blocks_.reset(static_cast<BlockDCT::Block *>(storage));
+    capacity_ = required;
+}
+
+int CoefficientPlane::width() const
+{
+    return width_;
+}
+
+int CoefficientPlane::height() const
+{
+    return height_;
+}
+
+int CoefficientPlane::blockColumns() const
+{
+    return blockColumns_;
+}
+
+int CoefficientPlane::blockRows() const
+{
+    return blockRows_;
+}
+
+std::size_t CoefficientPlane::blockCount() const
+{
+    return static_cast<std::size_t>(blockColumns_) * static_cast<std::size_t>(blockRows_);
+}
+
+BlockDCT::Block &CoefficientPlane::block(int col, int row)
+{
+    return blocks_[static_cast<std::size_t>(row) * blockColumns_ + col];
+}
+
+const BlockDCT::Block &CoefficientPlane::block(int col, int row) const
+{
+    return blocks_[static_cast<std::size_t>(row) * blockColumns_ + col];
+}
+
+BlockDCT::Block *CoefficientPlane::data()
+{
+    return blocks_.get();
+}
+
+const BlockDCT::Block *CoefficientPlane::data() const
+{
+    return blocks_.get();
+}
+
+void CoefficientPlane::AlignedDelete::operator()(BlockDCT::Block *blocks) const
+{
+    ::operator delete[](blocks, std::align_val_t { alignment });
+}
+}
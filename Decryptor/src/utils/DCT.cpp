@@ -4,131 +4,323 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
 #include <algorithm>
+#include <array>
 #include <boost/math/constants/constants.hpp>
-#include <iterator>
-#include <numeric>
-#include <type_traits>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
 
 #include "DCT.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace utils {
+namespace {
+/**
+ * @brief Level shift applied to samples, centers 8 bit samples around zero.
+ */
+constexpr float levelShift { 128.f };
+
+/**
+ * @brief Determine if @p image could be read as QRgb scanlines directly.
+ * @param image Image to check.
+ * @return True if @p image is stored as 0xAARRGGBB.
+ */
+bool isARGB32Layout(const QImage &image)
+{
+    return image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_RGB32;
+}
+
+/**
+ * @brief Bit offset of @p channel inside of QRgb.
+ * @param channel Channel to locate.
+ * @return Bit offset of the channel.
+ */
+int channelShift(DCT::Channel channel)
+{
+    switch (channel) {
+    case DCT::Channel::Red:
+        return 16;
+    case DCT::Channel::Green:
+        return 8;
+    case DCT::Channel::Blue:
+        return 0;
+    case DCT::Channel::Alpha:
+        return 24;
+    }
+    return 0;
+}
+
+/**
+ * @brief Amount of tiles scheduled per worker thread, more tiles than workers balance uneven tiles.
+ */
+constexpr int tilesPerWorker { 4 };
+
+/**
+ * @brief Split block rows into tiles and transform them on utils::ThreadPool.
+ * @param blockRows Amount of block rows of the plane.
+ * @param body Function which process block rows in [first, last), called once per tile.
+ */
+void forEachTile(int blockRows, const std::function<void(int, int)> &body)
+{
+    auto &pool = ThreadPool::getInstance();
+    const int tiles { static_cast<int>(pool.threadCount()) * tilesPerWorker };
+    const int rowsPerTile { std::max(1, (blockRows + tiles - 1) / tiles) };
+    const int tileCount { (blockRows + rowsPerTile - 1) / rowsPerTile };
+
+    pool.parallelFor(static_cast<std::size_t>(tileCount), [&](std::size_t tile) {
+        const int firstRow { static_cast<int>(tile) * rowsPerTile };
+        body(firstRow, std::min(firstRow + rowsPerTile, blockRows));
+    });
+}
+
+/**
+ * @brief Evaluate cos((2 * @p sample + 1) * @p frequency * pi / 2N) together with the normalization of
+ * @p frequency, N is the block size.
+ * @param frequency Frequency of the basis.
+ * @param sample Position of the sample.
+ * @return Value of the orthonormal basis.
+ */
+double referenceBasis(std::size_t frequency, std::size_t sample)
+{
+    namespace boost_const = boost::math::double_constants;
+    constexpr auto blockSize = static_cast<double>(BlockDCT::blockSize);
+    const double scale { std::sqrt((frequency == 0 ? 1.0 : 2.0) / blockSize) };
+    return scale * std::cos((2.0 * sample + 1.0) * frequency * boost_const::pi / (2.0 * blockSize));
+}
+
+/**
+ * @brief Transform a block by evaluating the 2D DCT formula for every coefficient.
+ * @param block Samples to transform in place.
+ */
+void referenceTransform(BlockDCT::Block &block)
+{
+    constexpr auto blockSize = BlockDCT::blockSize;
+    BlockDCT::Block rslt;
+    for (std::size_t v = 0; v < blockSize; v++) {
+        for (std::size_t u = 0; u < blockSize; u++) {
+            double sum { 0.0 };
+            for (std::size_t y = 0; y < blockSize; y++) {
+                for (std::size_t x = 0; x < blockSize; x++)
+                    sum += block[y * blockSize + x] * referenceBasis(u, x) * referenceBasis(v, y);
+            }
+            rslt[v * blockSize + u] = static_cast<float>(sum);
+        }
+    }
+    block = rslt;
+}
+
+/**
+ * @brief Inverse transform a block by evaluating the 2D inverse DCT formula for every sample.
+ * @param block Coefficients to transform in place.
+ */
+void referenceITransform(BlockDCT::Block &block)
+{
+    constexpr auto blockSize = BlockDCT::blockSize;
+    BlockDCT::Block rslt;
+    for (std::size_t y = 0; y < blockSize; y++) {
+        for (std::size_t x = 0; x < blockSize; x++) {
+            double sum { 0.0 };
+            for (std::size_t v = 0; v < blockSize; v++) {
+                for (std::size_t u = 0; u < blockSize; u++)
+                    sum += block[v * blockSize + u] * referenceBasis(u, x) * referenceBasis(v, y);
+            }
+            rslt[y * blockSize + x] = static_cast<float>(sum);
+        }
+    }
+    block = rslt;
+}
+
+/**
+ * @brief Round block into integers.
+ * @param block Block to round.
+ * @return Rounded block.
+ */
+FastDCT::IntegerBlock toInteger(const BlockDCT::Block &block)
+{
+    FastDCT::IntegerBlock rslt;
+    std::transform(block.begin(), block.end(), rslt.begin(),
+                   [](const auto &value) { return static_cast<std::int32_t>(std::lround(value)); });
+    return rslt;
+}
+
+/**
+ * @brief Convert integer block back into float.
+ * @param block Block to convert.
+ * @return Converted block.
+ */
+BlockDCT::Block toFloat(const FastDCT::IntegerBlock &block)
+{
+    BlockDCT::Block rslt;
+    std::transform(block.begin(), block.end(), rslt.begin(),
+                   [](const auto &value) { return static_cast<float>(value); });
+    return rslt;
+}
+}
+
+DCT::DCT(Mode mode) : mode_ { mode } { }
+
 std::vector<std::vector<float>> DCT::transfrom(const std::vector<std::vector<float>> &input)
 {
-    std::vector<std::vector<float>> rsltTransform;
-    rsltTransform.reserve(input.size());
-    transfromVector(input, rsltTransform);
-    return rsltTransform;
+    auto block = toBlock(input);
+    std::transform(block.begin(), block.end(), block.begin(),
+                   [](const auto &sample) { return sample - levelShift; });
+    transformBlocks(&block, 1);
+    return fromBlock(block);
 }
 
 std::vector<std::vector<float>> DCT::itransform(const std::vector<std::vector<float>> &input)
 {
-    std::vector<std::vector<float>> rsltTransform;
-    rsltTransform.reserve(input.size());
-    itransfromVector(input, rsltTransform);
-    return rsltTransform;
-}
-
-void DCT::transfromVector(const std::vector<std::vector<float>> &input,
-                          std::vector<std::vector<float>> &rslt)
-{
-    namespace boost_const = boost::math::float_constants;
-    auto u = static_cast<std::size_t>(-1);
-    auto v = static_cast<std::size_t>(-1);
-    constexpr float quarter = 1.f / 4.f;
-
-    std::transform(
-            input.begin(), input.end(), std::back_inserter(rslt), [&, rslt](const auto &row) {
-                u >= input.size() - 1 ? u = 0 : u++;
-                std::remove_reference<decltype(rslt)>::type::value_type rsltRow;
-                rsltRow.reserve(8);
-                std::transform(row.begin(), row.end(), std::back_inserter(rsltRow),
-                               [&](const auto &) {
-                                   v >= row.size() - 1 ? v = 0 : v++;
-                                   const float aU { u == 0 ? boost_const::one_div_root_two : 1.f };
-                                   const float aV { v == 0 ? boost_const::one_div_root_two : 1.f };
-                                   float rsltSum { dctAdder(input, u, v) };
-                                   rsltSum *= quarter * aU * aV;
-                                   return rsltSum;
-                               });
-
-                return rsltRow;
-            });
-}
-
-void DCT::itransfromVector(const std::vector<std::vector<float>> &input,
-                           std::vector<std::vector<float>> &rslt)
-{
-    constexpr float quarter = 1.f / 4.f;
-    auto x = static_cast<std::size_t>(-1);
-    auto y = static_cast<std::size_t>(-1);
-
-    std::transform(input.begin(), input.end(), std::back_inserter(rslt),
-                   [&, rslt](const auto &row) {
-                       x >= input.size() - 1 ? x = 0 : x++;
-                       std::remove_reference<decltype(rslt)>::type::value_type rsltRow;
-                       rsltRow.reserve(row.size());
-
-                       std::transform(row.begin(), row.end(), std::back_inserter(rsltRow),
-                                      [&](const auto &) {
-                                          y >= row.size() - 1 ? y = 0 : y++;
-                                          float nwValue { idctAdder(input, x, y) };
-                                          return (nwValue * quarter) + 128.f;
-                                      });
-
-                       return rsltRow;
-                   });
-}
-
-float DCT::dctAdder(const std::vector<std::vector<float>> &input, int u, int v)
-{
-    namespace boost_const = boost::math::float_constants;
-    auto x = static_cast<std::size_t>(-1);
-    auto y = static_cast<std::size_t>(-1);
-
-    return std::accumulate(
-            input.begin(), input.end(), 0.f, [&](const auto &prevRowSum, const auto &curRow) {
-                x >= input.size() - 1 ? x = 0 : x++;
-                return std::accumulate(
-                        curRow.begin(), curRow.end(), prevRowSum,
-                        [&](const auto &prevSum, const auto &curVal) {
-                            y >= curRow.size() - 1 ? y = 0 : y++;
-
-                            return prevSum
-                                    + ((curVal - 128.f)
-                                       * std::cos((((2.f * static_cast<float>(x)) + 1.f)
-                                                   * static_cast<float>(u) * boost_const::pi)
-                                                  / 16.f)
-                                       * std::cos((((2.f * static_cast<float>(y)) + 1.f)
-                                                   * static_cast<float>(v) * boost_const::pi)
-                                                  / 16.f));
-                        });
-            });
-}
-
-float DCT::idctAdder(const std::vector<std::vector<float>> &input, int x, int y)
-{
-    namespace boost_const = boost::math::float_constants;
-    auto u = static_cast<std::size_t>(-1);
-    auto v = static_cast<std::size_t>(-1);
-    return std::accumulate(
-            input.begin(), input.end(), 0.f, [&](const auto &prevRowSum, const auto &curRow) {
-                u >= input.size() - 1 ? u = 0 : u++;
-                return std::accumulate(
-                        curRow.begin(), curRow.end(), prevRowSum,
-                        [&](const auto &prevSum, const auto &curVal) {
-                            v >= curRow.size() - 1 ? v = 0 : v++;
-                            const float aU { u == 0 ? boost_const::one_div_root_two : 1.f };
-                            const float aV { v == 0 ? boost_const::one_div_root_two : 1.f };
-
-                            return prevSum
-                                    + (aU * aV * curVal
-                                       * std::cos((((2.f * static_cast<float>(x)) + 1.f)
-                                                   * static_cast<float>(u) * boost_const::pi)
-                                                  / 16.f)
-                                       * std::cos((((2.f * static_cast<float>(y)) + 1.f)
-                                                   * static_cast<float>(v) * boost_const::pi)
-                                                  / 16.f));
-                        });
-            });
-}
-}
\ No newline at end of file
+    auto block = toBlock(input);
+    itransformBlocks(&block, 1);
+    std::transform(block.begin(), block.end(), block.begin(),
+                   [](const auto &sample) { return sample + levelShift; });
+    return fromBlock(block);
+}
+
+void DCT::transformPlane(const QImage &image, Channel channel, CoefficientPlane &plane)
+{
+    constexpr auto blockSize = static_cast<int>(BlockDCT::blockSize);
+    const QImage source { isARGB32Layout(image) ? image
+                                                : image.convertToFormat(QImage::Format_ARGB32) };
+    const int width { source.width() };
+    const int height { source.height() };
+    const int shift { channelShift(channel) };
+    plane.resize(width, height);
+    if (plane.blockCount() == 0) return;
+
+    forEachTile(plane.blockRows(), [&](int firstRow, int lastRow) {
+        std::array<const QRgb *, BlockDCT::blockSize> lines;
+        for (int row = firstRow; row < lastRow; row++) {
+            for (int y = 0; y < blockSize; y++) {
+                const int srcY { std::min(row * blockSize + y, height - 1) };
+                lines[y] = reinterpret_cast<const QRgb *>(source.constScanLine(srcY));
+            }
+
+            for (int col = 0; col < plane.blockColumns(); col++) {
+                auto &block = plane.block(col, row);
+                for (int y = 0; y < blockSize; y++) {
+                    for (int x = 0; x < blockSize; x++) {
+                        const int srcX { std::min(col * blockSize + x, width - 1) };
+                        const auto sample = (lines[y][srcX] >> shift) & 0xffu;
+                        block[y * blockSize + x] = static_cast<float>(sample) - levelShift;
+                    }
+                }
+            }
+            transformBlocks(&plane.block(0, row), plane.blockColumns());
+        }
+    });
+}
+
+void DCT::itransformPlane(const CoefficientPlane &plane, Channel channel, QImage &image)
+{
+    if (image.width() != plane.width() || image.height() != plane.height())
+        throw std::invalid_argument { "Size of image does not match the coefficient plane." };
+
+    if (plane.blockCount() == 0) return;
+    if (!isARGB32Layout(image)) image = image.convertToFormat(QImage::Format_ARGB32);
+
+    constexpr auto blockSize = static_cast<int>(BlockDCT::blockSize);
+    const int shift { channelShift(channel) };
+    const QRgb mask { ~(QRgb { 0xffu } << shift) };
+    // Detach once here, scanLine() of a shared image is not safe to call from the workers.
+    uchar *bits { image.bits() };
+    const auto bytesPerLine = static_cast<std::ptrdiff_t>(image.bytesPerLine());
+
+    forEachTile(plane.blockRows(), [&](int firstRow, int lastRow) {
+        std::vector<BlockDCT::Block> blockRow(plane.blockColumns());
+        for (int row = firstRow; row < lastRow; row++) {
+            const int rowsInBlock { std::min(blockSize, plane.height() - row * blockSize) };
+            std::copy_n(&plane.block(0, row), blockRow.size(), blockRow.begin());
+            itransformBlocks(blockRow.data(), blockRow.size());
+
+            for (int col = 0; col < plane.blockColumns(); col++) {
+                const int colsInBlock { std::min(blockSize, plane.width() - col * blockSize) };
+                const auto &samples = blockRow[col];
+
+                for (int y = 0; y < rowsInBlock; y++) {
+                    const std::ptrdiff_t offset { (row * blockSize + y) * bytesPerLine };
+                    auto line = reinterpret_cast<QRgb *>(bits + offset);
+                    for (int x = 0; x < colsInBlock; x++) {
+                        const float sample { std::round(samples[y * blockSize + x] + levelShift) };
+                        const auto value = static_cast<QRgb>(std::clamp(sample, 0.f, 255.f));
+                        auto &pixel = line[col * blockSize + x];
+                        pixel = (pixel & mask) | (value << shift);
+                    }
+                }
+            }
+        }
+    });
+}
+
+DCT::Mode DCT::mode() const
+{
+    return mode_;
+}
+
+void DCT::transformBlocks(BlockDCT::Block *blocks, std::size_t count) const
+{
+    switch (mode_) {
+    case Mode::Reference:
+        std::for_each(blocks, blocks + count, referenceTransform);
+        break;
+    case Mode::Separable:
+        batch_.transformBlocks(blocks, count);
+        break;
+    case Mode::FastFloat:
+        std::for_each(blocks, blocks + count, [&](auto &block) { fast_.transform(block, block); });
+        break;
+    case Mode::FastInteger:
+        std::for_each(blocks, blocks + count, [&](auto &block) {
+            auto coefficients = toInteger(block);
+            fast_.transform(coefficients, coefficients);
+            block = toFloat(coefficients);
+        });
+        break;
+    }
+}
+
+void DCT::itransformBlocks(BlockDCT::Block *blocks, std::size_t count) const
+{
+    switch (mode_) {
+    case Mode::Reference:
+        std::for_each(blocks, blocks + count, referenceITransform);
+        break;
+    case Mode::Separable:
+        batch_.itransformBlocks(blocks, count);
+        break;
+    case Mode::FastFloat:
+        std::for_each(blocks, blocks + count, [&](auto &block) { fast_.itransform(block, block); });
+        break;
+    case Mode::FastInteger:
+        std::for_each(blocks, blocks + count, [&](auto &block) {
+            auto samples = toInteger(block);
+            fast_.itransform(samples, samples);
+            block = toFloat(samples);
+        });
+        break;
+    }
+}
+
+BlockDCT::Block DCT::toBlock(const std::vector<std::vector<float>> &input)
+{
+    constexpr auto blockSize = BlockDCT::blockSize;
+    auto isBlockRow = [](const auto &row) { return row.size() == blockSize; };
+    if (input.size() != blockSize || !std::all_of(input.begin(), input.end(), isBlockRow))
+        throw std::invalid_argument { "utils::DCT only support 8x8 blocks." };
+
+    BlockDCT::Block block;
+    auto itrBlock = block.begin();
+    for (const auto &row : input) itrBlock = std::copy(row.begin(), row.end(), itrBlock);
+    return block;
+}
+
+std::vector<std::vector<float>> DCT::fromBlock(const BlockDCT::Block &block)
+{
+    constexpr auto blockSize = BlockDCT::blockSize;
+    std::vector<std::vector<float>> rslt;
+    rslt.reserve(blockSize);
+    for (auto itrRow = block.begin(); itrRow != block.end(); itrRow += blockSize)
+        rslt.emplace_back(itrRow, itrRow + blockSize);
+    return rslt;
+}
+}
@@ -0,0 +1,65 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "utils/BlockDCT.hpp"
+
+namespace utils {
+/**
+ * @brief Factorized 8x8 DCT engine, the same algorithms JPEG codecs use.
+ *
+ * The float transform is the Arai-Agui-Nakajima factorization, which only needs 5 multiplications per
+ * 1D pass and fold the remaining scaling into a single multiplication per coefficient. The integer
+ * transform is the Loeffler-Ligtenberg-Moschytz factorization with 12 multiplications per 1D pass in
+ * 13 bit fixed point, the algorithm of the "islow" DCT of libjpeg. Unlike libjpeg, which leaves its output
+ * scaled up by 8, it is descaled to orthonormal coefficients, within +-1 of the float reference. Both
+ * transforms are interchangeable with utils::BlockDCT.
+ */
+class FastDCT
+{
+public:
+    /**
+     * @brief Row major block of integer samples or coefficients.
+     */
+    using IntegerBlock = std::array<std::int32_t, BlockDCT::blockArea>;
+
+public:
+    /**
+     * @brief Transform block of samples into DCT coefficients with AAN factorization.
+     * @param input Samples of the block.
+     * @param output Coefficients of the block, coefficient of frequency (u, v) locate at [v * 8 + u].
+     *
+     * @note @p input and @p output may refer to the same block.
+     */
+    void transform(const BlockDCT::Block &input, BlockDCT::Block &output) const;
+    /**
+     * @brief Transform block of DCT coefficients back into samples with AAN factorization.
+     * @param input Coefficients of the block.
+     * @param output Samples of the block.
+     *
+     * @note @p input and @p output may refer to the same block.
+     */
+    void itransform(const BlockDCT::Block &input, BlockDCT::Block &output) const;
+    /**
+     * @brief Transform block of samples into rounded DCT coefficients in fixed point.
+     * @param input Level shifted samples of the block, must be within [-128, 127].
+     * @param output Coefficients of the block, coefficient of frequency (u, v) locate at [v * 8 + u].
+     *
+     * @note @p input and @p output may refer to the same block.
+     */
+    void transform(const IntegerBlock &input, IntegerBlock &output) const;
+    /**
+     * @brief Transform block of DCT coefficients back into rounded samples in fixed point.
+     * @param input Coefficients of the block.
+     * @param output Level shifted samples of the block, not clamped.
+     *
+     * @note @p input and @p output may refer to the same block.
+     */
+    void itransform(const IntegerBlock &input, IntegerBlock &output) const;
+};
+}
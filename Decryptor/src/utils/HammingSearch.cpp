@@ -0,0 +1,175 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+#include "utils/CPUFeatures.hpp"
+#include "utils/HammingSearch.hpp"
+#include "utils/HammingSearchKernel.hpp"
+
+namespace utils {
+namespace hamming {
+namespace {
+/**
+ * @brief Count set bits of a word with bit arithmetic, summing bits in pairs, nibbles then bytes.
+ */
+std::uint64_t popcount(std::uint64_t value)
+{
+    value -= (value >> 1) & 0x5555555555555555ull;
+    value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+    value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (value * 0x0101010101010101ull) >> 56;
+}
+}
+
+void distancesScalar(const std::uint64_t *query, std::size_t words, const std::uint64_t *hashes,
+                     std::size_t count, std::uint16_t *distances)
+{
+    for (std::size_t idx = 0; idx < count; idx++, hashes += words) {
+        std::uint64_t distance { 0 };
+        for (std::size_t word = 0; word < words; word++)
+            distance += popcount(hashes[word] ^ query[word]);
+        distances[idx] = static_cast<std::uint16_t>(distance);
+    }
+}
+}
+
+static_assert(sizeof(HammingSearch::WideHash) == HammingSearch::wideWords * sizeof(std::uint64_t),
+              "Wide hashes must be contiguous words.");
+
+HammingSearch::HammingSearch() : HammingSearch(detectBackend()) { }
+
+HammingSearch::HammingSearch(Backend backend) : backend_ { backend }
+{
+    if (!isSupported(backend))
+        throw std::invalid_argument { "Selected distance kernel is not supported by the CPU." };
+
+    switch (backend) {
+    case Backend::Scalar:
+        kernel_ = &hamming::distancesScalar;
+        break;
+#ifdef ADSI_ARCH_X86
+    case Backend::POPCNT:
+        kernel_ = &hamming::distancesPOPCNT;
+        break;
+    case Backend::AVX2:
+        kernel_ = &hamming::distancesAVX2;
+        break;
+#endif // ADSI_ARCH_X86
+    default:
+        throw std::invalid_argument { "Selected distance kernel is not supported by the CPU." };
+    }
+}
+
+HammingSearch::Backend HammingSearch::detectBackend()
+{
+    for (auto backend : { Backend::AVX2, Backend::POPCNT }) {
+        if (isSupported(backend)) return backend;
+    }
+    return Backend::Scalar;
+}
+
+bool HammingSearch::isSupported(Backend backend)
+{
+    const auto &features = CPUFeatures::getInstance();
+    switch (backend) {
+    case Backend::Scalar:
+        return true;
+    case Backend::POPCNT:
+        return features.hasPOPCNT();
+    case Backend::AVX2:
+        return features.hasAVX2();
+    }
+    return false;
+}
+
+std::string_view HammingSearch::nameOf(Backend backend)
+{
+    switch (backend) {
+    case Backend::Scalar:
+        return "scalar";
+    case Backend::POPCNT:
+        return "popcnt";
+    case Backend::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void HammingSearch::distances(std::uint64_t query, const std::uint64_t *hashes, std::size_t count,
+                              std::uint16_t *distances) const
+{
+    kernel_(&query, 1, hashes, count, distances);
+}
+
+void HammingSearch::distances(const WideHash &query, const WideHash *hashes, std::size_t count,
+                              std::uint16_t *distances) const
+{
+    kernel_(query.data(), wideWords, reinterpret_cast<const std::uint64_t *>(hashes), count,
+            distances);
+}
+
+std::vector<HammingSearch::Match> HammingSearch::nearest(std::uint64_t query,
+                                                         const std::uint64_t *hashes,
+                                                         std::size_t count, int threshold,
+                                                         std::size_t k) const
+{
+    return nearest(&query, 1, hashes, count, threshold, k);
+}
+
+std::vector<HammingSearch::Match> HammingSearch::nearest(const WideHash &query,
+                                                         const WideHash *hashes, std::size_t count,
+                                                         int threshold, std::size_t k) const
+{
+    return nearest(query.data(), wideWords, reinterpret_cast<const std::uint64_t *>(hashes), count,
+                   threshold, k);
+}
+
+HammingSearch::Backend HammingSearch::backend() const
+{
+    return backend_;
+}
+
+std::vector<HammingSearch::Match> HammingSearch::nearest(const std::uint64_t *query,
+                                                         std::size_t words,
+                                                         const std::uint64_t *hashes,
+                                                         std::size_t count, int threshold,
+                                                         std::size_t k) const
+{
+    std::vector<Match> matches;
+    if (k == 0) return matches;
+
+    // Max heap of the k best matches, its top is the worst of them.
+    const auto isCloser = [](const Match &lhs, const Match &rhs) {
+        return std::tie(lhs.distance, lhs.index) < std::tie(rhs.distance, rhs.index);
+    };
+    matches.reserve(k + 1);
+
+    std::vector<std::uint16_t> distances(std::min(count, chunkSize));
+    int limit { threshold };
+    for (std::size_t first = 0; first < count; first += chunkSize) {
+        const std::size_t szChunk { std::min(chunkSize, count - first) };
+        kernel_(query, words, hashes + first * words, szChunk, distances.data());
+
+        for (std::size_t idx = 0; idx < szChunk; idx++) {
+            if (distances[idx] > limit) continue;
+
+            matches.push_back({ first + idx, distances[idx] });
+            std::push_heap(matches.begin(), matches.end(), isCloser);
+            if (matches.size() > k) {
+                std::pop_heap(matches.begin(), matches.end(), isCloser);
+                matches.pop_back();
+            }
+            // Later hashes have larger indices, only a strictly closer one could enter a full heap.
+            if (matches.size() == k) limit = matches.front().distance - 1;
+        }
+    }
+
+    std::sort_heap(matches.begin(), matches.end(), isCloser);
+    return matches;
+}
+}
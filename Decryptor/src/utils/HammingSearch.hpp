@@ -0,0 +1,168 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+/**
+ * @brief Vectorized engine which compare a hash against a contiguous array of stored hashes.
+ *
+ * Hashes are 64 bits, as utils::PerceptualHash, or 256 bits stored as 4 words. The kernel is chosen at
+ * runtime from the instruction sets supported by the CPU: AVX2 counts bits of 4 words at a time with a
+ * nibble lookup table, POPCNT counts a word per instruction, and the scalar kernel counts with bit
+ * arithmetic. Every kernel produces the same distances.
+ */
+class HammingSearch
+{
+public:
+    /**
+     * @brief Amount of 64-bit words of a wide hash.
+     */
+    static constexpr std::size_t wideWords { 4 };
+    /**
+     * @brief Amount of stored hashes compared before the matches are collected.
+     */
+    static constexpr std::size_t chunkSize { 4096 };
+    /**
+     * @brief 256-bit hash, first word holds the most significant bits.
+     */
+    using WideHash = std::array<std::uint64_t, wideWords>;
+    /**
+     * @brief Kernel implementations.
+     */
+    enum class Backend {
+        Scalar, /**< Portable bit arithmetic kernel. */
+        POPCNT, /**< POPCNT instruction kernel. */
+        AVX2 /**< 256 bit AVX2 lookup table kernel. */
+    };
+
+    /**
+     * @brief Stored hash found close to a query.
+     */
+    struct Match
+    {
+        /**
+         * @brief Index of the hash in the stored array.
+         */
+        std::size_t index;
+        /**
+         * @brief Amount of bits which differ from the query.
+         */
+        int distance;
+    };
+
+public:
+    /**
+     * @brief Create search with the fastest kernel supported by the CPU.
+     */
+    HammingSearch();
+    /**
+     * @brief Create search with specific kernel.
+     * @param backend Kernel to use.
+     * @throw std::invalid_argument if @p backend is not supported by the CPU.
+     */
+    explicit HammingSearch(Backend backend);
+
+    /**
+     * @brief Get the fastest kernel supported by the CPU.
+     * @return Fastest kernel available.
+     */
+    static Backend detectBackend();
+    /**
+     * @brief Determine if @p backend could run on the CPU.
+     * @param backend Kernel to check.
+     * @return True if @p backend is supported.
+     */
+    static bool isSupported(Backend backend);
+    /**
+     * @brief Get name of @p backend.
+     * @param backend Kernel to name.
+     * @return Human readable name of @p backend.
+     */
+    static std::string_view nameOf(Backend backend);
+
+    /**
+     * @brief Compute distance between a hash and every stored hash.
+     * @param query Hash to compare.
+     * @param hashes First stored hash.
+     * @param count Amount of stored hashes.
+     * @param distances Distance to each stored hash, @p count of them are written.
+     */
+    void distances(std::uint64_t query, const std::uint64_t *hashes, std::size_t count,
+                   std::uint16_t *distances) const;
+    /**
+     * @brief Compute distance between a wide hash and every stored wide hash.
+     *
+     * @sa distances(std::uint64_t, const std::uint64_t *, std::size_t, std::uint16_t *) const
+     */
+    void distances(const WideHash &query, const WideHash *hashes, std::size_t count,
+                   std::uint16_t *distances) const;
+    /**
+     * @brief Find the stored hashes closest to a hash.
+     *
+     * Distances are computed chunkSize hashes at a time, so no memory proportional to @p count is used.
+     *
+     * @param query Hash to look up.
+     * @param hashes First stored hash.
+     * @param count Amount of stored hashes.
+     * @param threshold Largest distance of a match.
+     * @param k Largest amount of matches.
+     * @return At most @p k matches within @p threshold, closest first then by index.
+     */
+    std::vector<Match> nearest(std::uint64_t query, const std::uint64_t *hashes, std::size_t count,
+                               int threshold, std::size_t k) const;
+    /**
+     * @brief Find the stored wide hashes closest to a wide hash.
+     *
+     * @sa nearest(std::uint64_t, const std::uint64_t *, std::size_t, int, std::size_t) const
+     */
+    std::vector<Match> nearest(const WideHash &query, const WideHash *hashes, std::size_t count,
+                               int threshold, std::size_t k) const;
+
+public: // Accessors
+    /**
+     * @brief Get kernel used by the search.
+     */
+    Backend backend() const;
+
+private:
+    /**
+     * @brief Signature of kernels, which take query, words per hash, stored hashes, amount of stored
+     * hashes and distances to write.
+     */
+    using Kernel = void (*)(const std::uint64_t *, std::size_t, const std::uint64_t *, std::size_t,
+                            std::uint16_t *);
+
+private:
+    /**
+     * @brief Find closest stored hashes of any width.
+     * @param query Words of the hash to look up.
+     * @param words Amount of words per hash.
+     * @param hashes Words of the stored hashes.
+     * @param count Amount of stored hashes.
+     * @param threshold Largest distance of a match.
+     * @param k Largest amount of matches.
+     * @return Matches, closest first then by index.
+     */
+    std::vector<Match> nearest(const std::uint64_t *query, std::size_t words,
+                               const std::uint64_t *hashes, std::size_t count, int threshold,
+                               std::size_t k) const;
+
+private:
+    /**
+     * @brief Kernel used by the search.
+     */
+    Backend backend_ { Backend::Scalar };
+    /**
+     * @brief Distance kernel.
+     */
+    Kernel kernel_ { nullptr };
+};
+}
@@ -0,0 +1,45 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include "utils/HammingSearchKernel.hpp"
+
+#ifdef ADSI_ARCH_X86
+#    include <nmmintrin.h>
+
+namespace utils::hamming {
+namespace {
+/**
+ * @brief Count set bits of a word with the POPCNT instruction.
+ */
+std::uint64_t popcount(std::uint64_t value)
+{
+#    if defined(__x86_64__) || defined(_M_X64)
+    return static_cast<std::uint64_t>(_mm_popcnt_u64(value));
+#    else
+    return static_cast<std::uint64_t>(_mm_popcnt_u32(static_cast<std::uint32_t>(value))
+                                      + _mm_popcnt_u32(static_cast<std::uint32_t>(value >> 32)));
+#    endif
+}
+}
+
+void distancesPOPCNT(const std::uint64_t *query, std::size_t words, const std::uint64_t *hashes,
+                     std::size_t count, std::uint16_t *distances)
+{
+    if (words == 1) {
+        const std::uint64_t word { query[0] };
+        for (std::size_t idx = 0; idx < count; idx++)
+            distances[idx] = static_cast<std::uint16_t>(popcount(hashes[idx] ^ word));
+        return;
+    }
+
+    for (std::size_t idx = 0; idx < count; idx++, hashes += words) {
+        std::uint64_t distance { 0 };
+        for (std::size_t word = 0; word < words; word++)
+            distance += popcount(hashes[word] ^ query[word]);
+        distances[idx] = static_cast<std::uint16_t>(distance);
+    }
+}
+}
+#endif // ADSI_ARCH_X86
@@ -0,0 +1,84 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace utils {
+/**
+ * @brief Quantized DCT coefficients of the luminance of a JPEG file.
+ *
+ * The file is read with libjpeg down to its coefficients, without decoding any pixel, and written back
+ * with the same quantization tables, sampling and markers. Coefficients which are not modified are
+ * preserved exactly, so a load and save round trip is lossless.
+ */
+class JPEGCoefficients
+{
+public:
+    /**
+     * @brief Width and height of a block.
+     */
+    static constexpr int blockSize { 8 };
+
+    /**
+     * @brief Read coefficients of a JPEG file.
+     * @param jpeg Content of the JPEG file.
+     * @throw std::runtime_error if @p jpeg is not a valid JPEG file.
+     */
+    explicit JPEGCoefficients(const std::vector<std::byte> &jpeg);
+    JPEGCoefficients(const JPEGCoefficients &) = delete;
+    JPEGCoefficients(JPEGCoefficients &&) noexcept;
+    JPEGCoefficients &operator=(const JPEGCoefficients &) = delete;
+    JPEGCoefficients &operator=(JPEGCoefficients &&) noexcept;
+    ~JPEGCoefficients();
+
+    /**
+     * @brief Write coefficients back into a JPEG file.
+     * @return Content of the JPEG file.
+     * @throw std::runtime_error if libjpeg failed to encode.
+     */
+    std::vector<std::byte> save() const;
+
+public: // Accessors
+    /**
+     * @brief Amount of blocks in a block row of the luminance.
+     */
+    int blockColumns() const;
+    /**
+     * @brief Amount of block rows of the luminance.
+     */
+    int blockRows() const;
+    /**
+     * @brief Get quantized coefficients of a luminance block in row major order.
+     *
+     * Blocks of a block row are contiguous. Every coefficient is kept in memory, so the pointer stays valid
+     * as long as the instance and could be used from any thread, while this accessor could not.
+     *
+     * @param col Column of the block.
+     * @param row Row of the block.
+     * @return Pointer to the 64 coefficients of the block.
+     */
+    std::int16_t *block(int col, int row);
+    /**
+     * @copydoc block(int, int)
+     */
+    const std::int16_t *block(int col, int row) const;
+
+private:
+    /**
+     * @brief libjpeg state, kept out of the header.
+     */
+    struct State;
+
+private:
+    /**
+     * @brief libjpeg state of the file read.
+     */
+    std::unique_ptr<State> state_;
+};
+}
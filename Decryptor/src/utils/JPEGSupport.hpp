@@ -0,0 +1,89 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <csetjmp>
+#include <cstdio>
+
+#include <jpeglib.h>
+
+namespace utils {
+/**
+ * @brief libjpeg error manager which jump back to the caller instead of exiting the process.
+ *
+ * Call setjmp() on jump before every libjpeg call, libjpeg longjmp there with the message formatted.
+ * Objects with non-trivial destructors must be constructed before the setjmp() call.
+ */
+struct JPEGErrorManager
+{
+    /**
+     * @brief Error manager of libjpeg, must stay the first member.
+     */
+    jpeg_error_mgr base;
+    /**
+     * @brief Context to jump back to on error.
+     */
+    std::jmp_buf jump;
+    /**
+     * @brief Message of the last error.
+     */
+    char message[JMSG_LENGTH_MAX];
+
+    /**
+     * @brief Install error manager on a libjpeg object.
+     * @return Base of the error manager to assign to the object.
+     */
+    jpeg_error_mgr *install()
+    {
+        auto result = jpeg_std_error(&base);
+        result->error_exit = exitOnError;
+        message[0] = '\0';
+        return result;
+    }
+
+private:
+    /**
+     * @brief Error handler of libjpeg, keep the message and jump to the last setjmp of the error manager.
+     * @param cinfo Object which raised the error.
+     */
+    [[noreturn]] static void exitOnError(j_common_ptr cinfo)
+    {
+        auto error = reinterpret_cast<JPEGErrorManager *>(cinfo->err);
+        (*cinfo->err->format_message)(cinfo, error->message);
+        std::longjmp(error->jump, 1);
+    }
+};
+
+/**
+ * @brief Ask a decompressor to keep the markers which are copied into a written file.
+ *
+ * JFIF and Adobe markers are written by libjpeg itself according to the parameters of the compressor, every
+ * other application and comment marker is kept. Must be called before jpeg_read_header().
+ *
+ * @param decompress Decompressor to set.
+ */
+inline void saveCopiedMarkers(jpeg_decompress_struct &decompress)
+{
+    for (int marker = JPEG_APP0 + 1; marker <= JPEG_APP0 + 15; marker++) {
+        if (marker != JPEG_APP0 + 14) jpeg_save_markers(&decompress, marker, 0xffff);
+    }
+    jpeg_save_markers(&decompress, JPEG_COM, 0xffff);
+}
+
+/**
+ * @brief Write markers kept by saveCopiedMarkers(jpeg_decompress_struct &) into a compressor.
+ *
+ * Must be called after jpeg_start_compress() or jpeg_write_coefficients(), before any data is written.
+ *
+ * @param decompress Decompressor which kept the markers.
+ * @param compress Compressor to write to.
+ */
+inline void writeCopiedMarkers(const jpeg_decompress_struct &decompress,
+                               jpeg_compress_struct &compress)
+{
+    for (auto marker = decompress.marker_list; marker != nullptr; marker = marker->next)
+        jpeg_write_marker(&compress, marker->marker, marker->data, marker->data_length);
+}
+}
@@ -0,0 +1,370 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QSaveFile>
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+#include "utils/SimilarityIndex.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Header of the index file, in native byte order.
+ *
+ * The header is followed by the hashes, the identifiers and the signers in the same order, then for
+ * each substring the first posting of every substring value plus the total, and the postings, the
+ * indices of the entries sorted by substring value.
+ */
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t substringCount;
+    std::uint64_t count;
+    std::uint64_t reserved;
+};
+
+constexpr char magic[8] { 'A', 'D', 'S', 'I', 'S', 'I', 'M', 'X' };
+constexpr std::uint32_t version { 2 };
+constexpr std::size_t valueCount { std::size_t { 1 } << SimilarityIndex::substringBits };
+/**
+ * @brief Amount of hashes scanned in the time a candidate of a substring table is verified. Candidates are
+ * read out of order, while scanned hashes are read in sequence by the vectorized kernels.
+ */
+constexpr std::size_t candidateCost { 64 };
+
+/**
+ * @brief Get size in bytes of the table of a substring.
+ */
+constexpr std::size_t tableSize(std::size_t count)
+{
+    return (valueCount + 1 + count) * sizeof(std::uint32_t);
+}
+
+/**
+ * @brief Get offset in bytes of the table of a substring.
+ */
+constexpr std::size_t tableOffset(std::size_t count, int substring)
+{
+    return sizeof(Header) + count * 3 * sizeof(std::uint64_t) + substring * tableSize(count);
+}
+
+/**
+ * @brief Get value of a substring, the first substring holds the most significant bits.
+ */
+std::uint32_t substringOf(std::uint64_t hash, int substring)
+{
+    const int shift { 64 - SimilarityIndex::substringBits * (substring + 1) };
+    return static_cast<std::uint32_t>((hash >> shift) & (valueCount - 1));
+}
+
+int distanceOf(std::uint64_t lhs, std::uint64_t rhs)
+{
+    return static_cast<int>(std::bitset<64>(lhs ^ rhs).count());
+}
+
+/**
+ * @brief Get amount of substring values within a distance of a value.
+ */
+std::size_t neighbourCount(int limit)
+{
+    std::size_t total { 0 }, binomial { 1 };
+    for (int bits = 0; bits <= limit && bits <= SimilarityIndex::substringBits; bits++) {
+        total += binomial;
+        binomial = binomial * (SimilarityIndex::substringBits - bits) / (bits + 1);
+    }
+    return total;
+}
+
+/**
+ * @brief Call @p visit with each substring mask of at most @p limit bits set.
+ */
+template<typename Visitor>
+void forEachMask(int limit, Visitor &&visit)
+{
+    visit(0u);
+    for (int bits = 1; bits <= limit && bits <= SimilarityIndex::substringBits; bits++) {
+        // Next mask with the same amount of bits set, in increasing order.
+        for (std::uint32_t mask = (1u << bits) - 1; mask < valueCount;) {
+            visit(mask);
+            const std::uint32_t lowest { mask & (~mask + 1) };
+            const std::uint32_t ripple { mask + lowest };
+            mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+        }
+    }
+}
+}
+
+SimilarityIndex &SimilarityIndex::getInstance()
+{
+    static SimilarityIndex instance;
+    return instance;
+}
+
+bool SimilarityIndex::load(const QString &path)
+{
+    std::lock_guard lock { mutex_ };
+    unmap();
+    removedIds_.clear();
+    removedCount_ = 0;
+    addedHashes_.clear();
+    addedIds_.clear();
+    addedSigners_.clear();
+
+    file_.setFileName(path);
+    if (!file_.exists()) return true;
+    return map();
+}
+
+bool SimilarityIndex::save()
+{
+    std::lock_guard lock { mutex_ };
+    if (file_.fileName().isEmpty()) return false;
+
+    std::vector<std::uint64_t> hashes, ids, signers;
+    hashes.reserve(mappedCount_ - removedCount_ + addedHashes_.size());
+    ids.reserve(hashes.capacity());
+    signers.reserve(hashes.capacity());
+    for (std::size_t idx = 0; idx < mappedCount_; idx++) {
+        if (isRemoved(idx)) continue;
+        hashes.push_back(mappedHashes_[idx]);
+        ids.push_back(mappedIds_[idx]);
+        signers.push_back(mappedSigners_[idx]);
+    }
+    hashes.insert(hashes.end(), addedHashes_.begin(), addedHashes_.end());
+    ids.insert(ids.end(), addedIds_.begin(), addedIds_.end());
+    signers.insert(signers.end(), addedSigners_.begin(), addedSigners_.end());
+
+    const std::size_t count { hashes.size() };
+    if (count > std::numeric_limits<std::uint32_t>::max()) return false;
+
+    Header header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.substringCount = substringCount;
+    header.count = count;
+
+    // The file is replaced, it must not be mapped meanwhile. It is written one table at a time, the
+    // whole index may not fit in a single buffer.
+    unmap();
+    QSaveFile output { file_.fileName() };
+    const auto write = [&output](const void *data, std::size_t size) {
+        return output.write(static_cast<const char *>(data), static_cast<qint64>(size))
+                == static_cast<qint64>(size);
+    };
+    bool saved { output.open(QIODevice::WriteOnly) && write(&header, sizeof(header))
+                 && write(hashes.data(), count * sizeof(std::uint64_t))
+                 && write(ids.data(), count * sizeof(std::uint64_t))
+                 && write(signers.data(), count * sizeof(std::uint64_t)) };
+
+    // Counting sort of the entries by the value of each substring.
+    std::vector<std::uint32_t> table(valueCount + 1 + count);
+    for (int substring = 0; saved && substring < substringCount; substring++) {
+        std::fill(table.begin(), table.end(), 0);
+        auto *offsets { table.data() };
+        auto *postings { offsets + valueCount + 1 };
+        for (auto hash : hashes)
+            offsets[substringOf(hash, substring) + 1]++;
+        for (std::size_t value = 0; value < valueCount; value++)
+            offsets[value + 1] += offsets[value];
+
+        std::vector<std::uint32_t> next(offsets, offsets + valueCount);
+        for (std::size_t idx = 0; idx < count; idx++)
+            postings[next[substringOf(hashes[idx], substring)]++] = static_cast<std::uint32_t>(idx);
+        saved = write(table.data(), tableSize(count));
+    }
+    if (!saved || !output.commit()) {
+        if (file_.exists()) map();
+        return false;
+    }
+
+    removedIds_.clear();
+    removedCount_ = 0;
+    addedHashes_.clear();
+    addedIds_.clear();
+    addedSigners_.clear();
+    return map();
+}
+
+std::uint64_t SimilarityIndex::signerOf(std::string_view fingerprint)
+{
+    std::uint64_t signer { 0 };
+    if (fingerprint.size() < sizeof(signer))
+        throw std::invalid_argument { "Parameter fingerprint is shorter than a signer." };
+
+    for (std::size_t idx = 0; idx < sizeof(signer); idx++)
+        signer |= std::uint64_t { static_cast<unsigned char>(fingerprint[idx]) } << (idx * 8);
+    return signer;
+}
+
+void SimilarityIndex::insert(std::uint64_t hash, std::uint64_t id, std::uint64_t signer)
+{
+    std::lock_guard lock { mutex_ };
+    addedHashes_.push_back(hash);
+    addedIds_.push_back(id);
+    addedSigners_.push_back(signer);
+}
+
+std::size_t SimilarityIndex::remove(std::uint64_t id)
+{
+    std::lock_guard lock { mutex_ };
+    std::size_t removed { 0 };
+    if (removedIds_.count(id) == 0) {
+        removed = static_cast<std::size_t>(std::count(mappedIds_, mappedIds_ + mappedCount_, id));
+        if (removed > 0) removedIds_.insert(id);
+        removedCount_ += removed;
+    }
+
+    for (std::size_t idx = addedIds_.size(); idx-- > 0;) {
+        if (addedIds_[idx] != id) continue;
+        addedIds_.erase(addedIds_.begin() + idx);
+        addedHashes_.erase(addedHashes_.begin() + idx);
+        addedSigners_.erase(addedSigners_.begin() + idx);
+        removed++;
+    }
+    return removed;
+}
+
+std::vector<SimilarityIndex::Match> SimilarityIndex::query(std::uint64_t hash, int radius) const
+{
+    std::lock_guard lock { mutex_ };
+    std::vector<Match> matches;
+    if (radius < 0) return matches;
+
+    // Probing reads the entries of each substring value within radius / substringCount in every table,
+    // beyond a few bits of radius scanning every hash is cheaper.
+    const std::size_t probes { neighbourCount(radius / substringCount) * substringCount };
+    const std::size_t candidates { probes * std::max<std::size_t>(1, mappedCount_ / valueCount) };
+    if (candidates * candidateCost < mappedCount_)
+        probe(hash, radius, matches);
+    else
+        scan(hash, radius, mappedHashes_, mappedIds_, mappedSigners_, mappedCount_, true, matches);
+    scan(hash, radius, addedHashes_.data(), addedIds_.data(), addedSigners_.data(),
+         addedHashes_.size(), false, matches);
+
+    std::sort(matches.begin(), matches.end(), [](const Match &lhs, const Match &rhs) {
+        return std::tie(lhs.distance, lhs.id) < std::tie(rhs.distance, rhs.id);
+    });
+    return matches;
+}
+
+bool SimilarityIndex::isSignedBy(std::uint64_t hash, std::uint64_t signer) const
+{
+    const auto matches = query(hash, matchRadius);
+    return !matches.empty() && matches.front().signer == signer;
+}
+
+std::size_t SimilarityIndex::size() const
+{
+    std::lock_guard lock { mutex_ };
+    return mappedCount_ - removedCount_ + addedHashes_.size();
+}
+
+void SimilarityIndex::unmap()
+{
+    if (mapped_ != nullptr) file_.unmap(mapped_);
+    file_.close();
+    mapped_ = nullptr;
+    mappedCount_ = 0;
+    mappedHashes_ = nullptr;
+    mappedIds_ = nullptr;
+    mappedSigners_ = nullptr;
+    std::fill(std::begin(offsets_), std::end(offsets_), nullptr);
+    std::fill(std::begin(postings_), std::end(postings_), nullptr);
+}
+
+bool SimilarityIndex::map()
+{
+    if (!file_.open(QIODevice::ReadOnly)) return false;
+
+    const auto szFile { static_cast<std::size_t>(file_.size()) };
+    Header header {};
+    if (szFile < sizeof(Header) || (mapped_ = file_.map(0, file_.size())) == nullptr) {
+        unmap();
+        return false;
+    }
+    std::memcpy(&header, mapped_, sizeof(header));
+
+    const std::size_t count { static_cast<std::size_t>(header.count) };
+    const bool valid { std::memcmp(header.magic, magic, sizeof(magic)) == 0
+                       && header.version == version && header.substringCount == substringCount
+                       && count <= std::numeric_limits<std::uint32_t>::max()
+                       && szFile == tableOffset(count, substringCount) };
+    if (!valid) {
+        unmap();
+        return false;
+    }
+
+    mappedCount_ = count;
+    mappedHashes_ = reinterpret_cast<const std::uint64_t *>(mapped_ + sizeof(Header));
+    mappedIds_ = mappedHashes_ + count;
+    mappedSigners_ = mappedIds_ + count;
+    for (int substring = 0; substring < substringCount; substring++) {
+        offsets_[substring] =
+                reinterpret_cast<const std::uint32_t *>(mapped_ + tableOffset(count, substring));
+        postings_[substring] = offsets_[substring] + valueCount + 1;
+        if (offsets_[substring][valueCount] != count) {
+            unmap();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SimilarityIndex::isRemoved(std::size_t idx) const
+{
+    return !removedIds_.empty() && removedIds_.count(mappedIds_[idx]) != 0;
+}
+
+void SimilarityIndex::probe(std::uint64_t hash, int radius, std::vector<Match> &matches) const
+{
+    const int limit { radius / substringCount };
+    for (int substring = 0; substring < substringCount; substring++) {
+        const std::uint32_t value { substringOf(hash, substring) };
+        const std::uint32_t *offsets { offsets_[substring] };
+        forEachMask(limit, [&](std::uint32_t mask) {
+            const std::uint32_t probed { value ^ mask };
+            const std::size_t last { std::min<std::size_t>(offsets[probed + 1], mappedCount_) };
+            for (std::size_t posting = offsets[probed]; posting < last; posting++) {
+                const std::size_t idx { postings_[substring][posting] };
+                if (idx >= mappedCount_ || isRemoved(idx)) continue;
+
+                // An entry close enough in an earlier substring was already found in its table.
+                const std::uint64_t stored { mappedHashes_[idx] };
+                bool found { false };
+                for (int earlier = 0; earlier < substring && !found; earlier++) {
+                    found = distanceOf(substringOf(stored, earlier), substringOf(hash, earlier))
+                            <= limit;
+                }
+                const int distance { distanceOf(stored, hash) };
+                if (!found && distance <= radius)
+                    matches.push_back({ mappedIds_[idx], stored, mappedSigners_[idx], distance });
+            }
+        });
+    }
+}
+
+void SimilarityIndex::scan(std::uint64_t hash, int radius, const std::uint64_t *hashes,
+                           const std::uint64_t *ids, const std::uint64_t *signers,
+                           std::size_t count, bool mapped, std::vector<Match> &matches) const
+{
+    std::vector<std::uint16_t> distances(std::min(count, HammingSearch::chunkSize));
+    for (std::size_t first = 0; first < count; first += HammingSearch::chunkSize) {
+        const std::size_t szChunk { std::min(HammingSearch::chunkSize, count - first) };
+        search_.distances(hash, hashes + first, szChunk, distances.data());
+        for (std::size_t idx = 0; idx < szChunk; idx++) {
+            if (distances[idx] > radius || (mapped && isRemoved(first + idx))) continue;
+            matches.push_back({ ids[first + idx], hashes[first + idx], signers[first + idx],
+                                distances[idx] });
+        }
+    }
+}
+}
@@ -0,0 +1,208 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <algorithm>
+#include <exception>
+
+#include "utils/ThreadPool.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Pool which own the calling thread, nullptr if it is not a worker.
+ */
+thread_local const ThreadPool *currentPool { nullptr };
+/**
+ * @brief Index of the queue owned by the calling thread, valid only if currentPool is set.
+ */
+thread_local std::size_t currentQueue { 0 };
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+ThreadPool &ThreadPool::getInstance()
+{
+    static ThreadPool instance;
+    return instance;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &body)
+{
+    if (count == 0) return;
+    if (workers_.empty()) {
+        std::exception_ptr error;
+        for (std::size_t idx = 0; idx < count; idx++) {
+            try {
+                body(idx);
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+        return;
+    }
+
+    struct Group
+    {
+        std::atomic<std::size_t> pending;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto group = std::make_shared<Group>();
+    group->pending = count;
+
+    for (std::size_t idx = 0; idx < count; idx++) {
+        push([group, &body, idx] {
+            try {
+                body(idx);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock { group->mutex };
+                if (!group->error) group->error = std::current_exception();
+            }
+
+            if (group->pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock { group->mutex };
+                group->finished.notify_all();
+            }
+        });
+    }
+
+    // Run queued tasks instead of blocking, so nested calls from a worker could not starve the pool.
+    const std::size_t self { currentPool == this ? currentQueue : queues_.size() };
+    Task task;
+    while (group->pending.load() > 0) {
+        if (tryPop(self, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock { group->mutex };
+        group->finished.wait(lock, [&] { return group->pending.load() == 0; });
+    }
+
+    if (group->error) std::rethrow_exception(group->error);
+}
+
+std::size_t ThreadPool::threadCount() const
+{
+    return workers_.size() + 1;
+}
+
+void ThreadPool::setThreadCount(std::size_t count)
+{
+    stop();
+    start(count);
+}
+
+ThreadPool::ThreadPool()
+{
+    start(0);
+}
+
+void ThreadPool::start(std::size_t count)
+{
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    count--;
+
+    queues_.reserve(count);
+    for (std::size_t idx = 0; idx < count; idx++)
+        queues_.emplace_back(std::make_unique<WorkQueue>());
+
+    workers_.reserve(count);
+    for (std::size_t idx = 0; idx < count; idx++)
+        workers_.emplace_back(&ThreadPool::run, this, idx);
+}
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock { wakeMutex_ };
+        stopping_ = true;
+    }
+    wakeUp_.notify_all();
+
+    for (auto &worker : workers_) worker.join();
+    workers_.clear();
+    queues_.clear();
+    stopping_ = false;
+}
+
+void ThreadPool::push(Task task)
+{
+    // Without workers there is no queue, the task runs on the calling thread.
+    if (queues_.empty()) {
+        task();
+        return;
+    }
+
+    const std::size_t target { currentPool == this ? currentQueue
+                                                   : nextQueue_.fetch_add(1) % queues_.size() };
+    // Count the task first, so a worker that find it later never decrease the counter below zero.
+    queued_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock { queues_[target]->mutex };
+        queues_[target]->tasks.emplace_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock { wakeMutex_ };
+    }
+    wakeUp_.notify_one();
+}
+
+bool ThreadPool::tryPop(std::size_t self, Task &task)
+{
+    const std::size_t count { queues_.size() };
+    if (self < count) {
+        auto &own = *queues_[self];
+        std::lock_guard<std::mutex> lock { own.mutex };
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset <= count; offset++) {
+        const std::size_t victimIdx { (self + offset) % count };
+        if (victimIdx == self) continue;
+
+        auto &victim = *queues_[victimIdx];
+        std::lock_guard<std::mutex> lock { victim.mutex };
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(std::size_t self)
+{
+    currentPool = this;
+    currentQueue = self;
+
+    Task task;
+    while (true) {
+        if (tryPop(self, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock { wakeMutex_ };
+        wakeUp_.wait(lock, [&] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) return;
+    }
+}
+}
@@ -0,0 +1,111 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <cryptopp/filters.h>
+#include <cryptopp/hex.h>
+
+#include "codec/SignaturePayload.hpp"
+#include "utils/TrustedKeyStore.hpp"
+
+namespace utils {
+namespace {
+using Payload = codec::SignaturePayload;
+}
+
+TrustedKeyStore &TrustedKeyStore::getInstance()
+{
+    static TrustedKeyStore instance;
+    return instance;
+}
+
+void TrustedKeyStore::load(const QString &path)
+{
+    path_ = path;
+    keys_.clear();
+
+    QDir directory { path };
+    for (const auto &fileName : directory.entryList(QDir::Files)) {
+        QFile file { directory.filePath(fileName) };
+        if (!file.open(QIODevice::ReadOnly)) continue;
+
+        const auto derKey = file.readAll();
+        try {
+            CryptoPP::RSA::PublicKey key;
+            const std::string_view data { derKey.constData(),
+                                          static_cast<std::size_t>(derKey.size()) };
+            CryptoPP::ArraySource source { reinterpret_cast<const CryptoPP::byte *>(data.data()),
+                                           data.size(), true };
+            key.BERDecode(source);
+            insert(data, std::move(key));
+        } catch (const CryptoPP::Exception &e) {
+            qDebug() << fileName << e.what();
+        }
+    }
+}
+
+bool TrustedKeyStore::add(const CryptoPP::RSA::PublicKey &key)
+{
+    if (contains(key)) return true;
+
+    std::string derKey;
+    CryptoPP::StringSink serializer { derKey };
+    key.DEREncode(serializer);
+
+    QDir directory { path_ };
+    if (!directory.mkpath(QStringLiteral("."))) return false;
+
+    const auto hexFingerprint = insert(derKey, key);
+    QFile file { directory.filePath(QString::fromStdString(hexFingerprint) + ".der") };
+    return file.open(QIODevice::WriteOnly)
+            && file.write(derKey.data(), static_cast<qint64>(derKey.size()))
+            == static_cast<qint64>(derKey.size());
+}
+
+bool TrustedKeyStore::contains(const CryptoPP::RSA::PublicKey &key) const
+{
+    std::string derKey;
+    CryptoPP::StringSink serializer { derKey };
+    key.DEREncode(serializer);
+
+    return find(Payload::fingerprint(derKey, Payload::fullFingerprintSize)) != nullptr;
+}
+
+const CryptoPP::RSA::PublicKey *TrustedKeyStore::find(std::string_view fingerprint) const
+{
+    if (fingerprint.size() < Payload::shortFingerprintSize) return nullptr;
+
+    auto entry = keys_.find(std::string { fingerprint.substr(0, Payload::shortFingerprintSize) });
+    if (entry == keys_.end()) return nullptr;
+
+    // A full fingerprint must match entirely, not only its short prefix.
+    if (fingerprint.size() > Payload::shortFingerprintSize
+        && entry->second.fingerprint != fingerprint)
+        return nullptr;
+
+    return &entry->second.key;
+}
+
+std::string TrustedKeyStore::insert(std::string_view derKey, CryptoPP::RSA::PublicKey key)
+{
+    auto fingerprint = Payload::fingerprint(derKey, Payload::fullFingerprintSize);
+    auto shortFingerprint = fingerprint.substr(0, Payload::shortFingerprintSize);
+
+    std::string hexFingerprint;
+    CryptoPP::StringSource encoder {
+        fingerprint, true,
+        new CryptoPP::HexEncoder { new CryptoPP::StringSink { hexFingerprint } }
+    };
+
+    keys_.try_emplace(std::move(shortFingerprint),
+                      Entry { std::move(fingerprint), std::move(key) });
+    return hexFingerprint;
+}
+
+TrustedKeyStore::TrustedKeyStore() { }
+}
@@ -0,0 +1,104 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QString>
+
+#include <cryptopp/rsa.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace utils {
+/**
+ * @brief Singleton object that holds the public keys trusted to resolve key fingerprints of signed images.
+ *
+ * Keys are stored one per file in a directory, DER encoded, named by the hex of their full fingerprint as
+ * computed by codec::SignaturePayload::fingerprint. Each key is parsed once when loaded, and the table is
+ * indexed by the short fingerprint, so both fingerprint sizes resolve with a single lookup into a key ready
+ * to verify with.
+ *
+ * A signed image may embed any key, so a key is never trusted just because an image verifies with it. The
+ * store is only filled from the configured key directory, or by add() when the user explicitly asks to
+ * trust a key.
+ */
+class TrustedKeyStore
+{
+public:
+    TrustedKeyStore(const TrustedKeyStore &) = delete;
+    TrustedKeyStore(TrustedKeyStore &&) = delete;
+    TrustedKeyStore &operator=(const TrustedKeyStore &) = delete;
+    TrustedKeyStore &operator=(TrustedKeyStore &&) = delete;
+
+    /**
+     * @brief Get unique instance of TrustedKeyStore.
+     * @return Unique instance of TrustedKeyStore.
+     */
+    static TrustedKeyStore &getInstance();
+
+    /**
+     * @brief Replace trusted keys with the keys of a directory, files which are not valid keys are skipped.
+     * @param path Path to the directory, keys added later are saved into it.
+     */
+    void load(const QString &path);
+    /**
+     * @brief Trust a key and save it into the directory loaded, nothing is done if it is already trusted.
+     *
+     * Only to be called on an explicit request of the user.
+     * @param key Key to trust.
+     * @return True if the key is trusted, false if it could not be saved.
+     */
+    bool add(const CryptoPP::RSA::PublicKey &key);
+    /**
+     * @brief Check if a key is trusted.
+     * @param key Key to check.
+     * @return True if the key is trusted.
+     */
+    bool contains(const CryptoPP::RSA::PublicKey &key) const;
+    /**
+     * @brief Find trusted key of a fingerprint.
+     * @param fingerprint Short or full fingerprint of the key.
+     * @return Trusted key, nullptr if no trusted key has the fingerprint.
+     */
+    const CryptoPP::RSA::PublicKey *find(std::string_view fingerprint) const;
+
+private:
+    /**
+     * @brief Trusted key with its full fingerprint.
+     */
+    struct Entry
+    {
+        /**
+         * @brief Full fingerprint of the key.
+         */
+        std::string fingerprint;
+        /**
+         * @brief Parsed key.
+         */
+        CryptoPP::RSA::PublicKey key;
+    };
+
+private:
+    TrustedKeyStore();
+
+    /**
+     * @brief Insert a key into the table.
+     * @param derKey DER encoded key.
+     * @param key Parsed key.
+     * @return Full fingerprint of the key, in hex.
+     */
+    std::string insert(std::string_view derKey, CryptoPP::RSA::PublicKey key);
+
+private:
+    /**
+     * @brief Directory the keys are loaded from.
+     */
+    QString path_;
+    /**
+     * @brief Trusted keys, by short fingerprint.
+     */
+    std::unordered_map<std::string, Entry> keys_;
+};
+}
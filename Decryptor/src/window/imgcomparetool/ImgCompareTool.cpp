@@ -7,15 +7,16 @@
 #include <QLabel>
 #include <QFileDialog>
 
-#include <boost/algorithm/string.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/process.hpp>
-#include <boost/process/windows.hpp>
+#include <array>
+
 #include <boost/scope_exit.hpp>
 #include <fmt/format.h>
 
 #include "window/imgcomparetool/ImgCompareTool.hpp"
+#include "utils/HashCache.hpp"
+#include "utils/ImageFingerprint.hpp"
 #include "utils/StylesManager.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace window {
 ImgCompareTool::ImgCompareTool(QWidget *parent): QDialog(parent)
@@ -59,37 +60,26 @@ void ImgCompareTool::onCompare()
 
     BOOST_SCOPE_EXIT_ALL(&, this) { QApplication::restoreOverrideCursor(); };
 
-    std::string argsHasher { fmt::format("./perceptual_hash.exe \"{}\" --hash",
-                                         lImgPath.toStdString()) };
-    boost::process::ipstream soutHasher;
-#if defined(WIN32) && !defined(DEBUG)
-    boost::process::child hasher { argsHasher, boost::process::std_out > soutHasher,
-                                   boost::process::windows::create_no_window };
-#else
-    boost::process::child hasher { argsHasher, boost::process::std_out > soutHasher};
-#endif // defined(WIN32) && !defined(DEBUG)
-    std::string hash;
-    std::getline(soutHasher, hash);
-    boost::trim(hash);
-    qDebug() << QString::fromStdString(hash);
-
-    argsHasher =
-            fmt::format("./perceptual_hash.exe \"{}\" --compare {}", rImgPath.toStdString(), hash);
-    soutHasher = decltype(soutHasher) {};
-#if defined(WIN32) && !defined(DEBUG)
-    hasher = decltype(hasher) { argsHasher, boost::process::std_out > soutHasher,
-                                boost::process::windows::create_no_window };
-#else
-    hasher = decltype(hasher) { argsHasher, boost::process::std_out > soutHasher };
-#endif // defined(WIN32) && !defined(DEBUG)
-    std::string rwMatchResult;
-    std::getline(soutHasher, rwMatchResult);
-    boost::trim(rwMatchResult);
-    int matchResult = boost::lexical_cast<int>(rwMatchResult);
-    qDebug() << matchResult;
+    // Both images are fingerprinted at once by the workers of the pool. Images compared before are not
+    // decoded again, others are decoded once for every hash.
+    const std::array<const QString *, 2> paths { &lImgPath, &rImgPath };
+    std::array<utils::ImageFingerprint, 2> fingerprints;
+    utils::ImageFingerprint::Distance matchResult;
+    try {
+        utils::ThreadPool::getInstance().parallelFor(paths.size(), [&](std::size_t idx) {
+            fingerprints[idx] = utils::HashCache::getInstance().fingerprintOf(*paths[idx]);
+        });
+        matchResult = fingerprints[0].distance(fingerprints[1]);
+    } catch (const std::exception &e) {
+        qDebug() << e.what();
+        ui_->labResult->setText(QStringLiteral("Unable to read the selected images."));
+        return;
+    }
 
-    std::string message { fmt::format("Differences: {}, Matched: {}", matchResult,
-                                      matchResult <= 30 ? "Yes" : "No") };
+    std::string message { fmt::format(
+            "Differences: {} (average {}, difference {}, wavelet {}), Matched: {}",
+            matchResult.perceptual, matchResult.average, matchResult.difference,
+            matchResult.wavelet, matchResult.perceptual <= 30 ? "Yes" : "No") };
     ui_->labResult->setText(QString::fromStdString(message));
 }
 }
\ No newline at end of file
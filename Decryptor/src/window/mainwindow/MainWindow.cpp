@@ -5,8 +5,8 @@
  *********************************************************************************************************************/
 #include <QDateTime>
 #include <QDebug>
+#include <QFile>
 #include <QFileDialog>
-#include <QFileInfo>
 #include <QGuiApplication>
 #include <QMessageBox>
 #include <QPixmap>
@@ -17,20 +17,21 @@
 #include <fstream>
 #include <stdexcept>
 #include <string>
-#include <sstream>
 
-#include <boost/algorithm/string.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/process.hpp>
-#include <boost/process/windows.hpp>
 #include <boost/range/irange.hpp>
 #include <boost/scope_exit.hpp>
+#include <cryptopp/filters.h>
 #include <fmt/format.h>
 
 #include "MainWindow.hpp"
 #include "codec/DefaultCodecFactory.hpp"
+#include "codec/SignaturePayload.hpp"
 #include "utils/DCT.hpp"
+#include "utils/HashCache.hpp"
+#include "utils/PerceptualHash.hpp"
+#include "utils/SimilarityIndex.hpp"
 #include "utils/StylesManager.hpp"
+#include "utils/TrustedKeyStore.hpp"
 #include "window/setting/Setting.hpp"
 #include "window/imgcomparetool/ImgCompareTool.hpp"
 
@@ -41,16 +42,6 @@ MainWindow::MainWindow(QWidget *parent)
     ui_->setupUi(this);
     initUI();
     loadStylesheet();
-
-#ifdef DEBUG
-    std::fstream test;
-    test.open("./perceptual_hash.exe", std::ios::in);
-    if (test.is_open()) {
-        qDebug() << "Found hash executable";
-        test.close();
-    }
-    if (QFileInfo::exists("./jsteg.exe")) qDebug() << QStringLiteral("Found jsteg executable");
-#endif // DEBUG
 }
 
 void MainWindow::onSettingClicked()
@@ -72,8 +63,6 @@ void MainWindow::onLoadImage()
 
 void MainWindow::onVerifyImage()
 {
-    namespace bp = boost::process;
-
     QApplication::setOverrideCursor(Qt::CursorShape::WaitCursor);
     BOOST_SCOPE_EXIT_ALL() { QApplication::restoreOverrideCursor(); };
 
@@ -84,6 +73,9 @@ void MainWindow::onVerifyImage()
     }
 
     std::vector<std::byte> signature;
+    bool match { false };
+    bool isEmbeddedKey { false };
+    const CryptoPP::RSA::PublicKey *key { &pbKey_ };
 
     try {
         signature = loadDataFromImage();
@@ -91,6 +83,38 @@ void MainWindow::onVerifyImage()
         if (signature.empty()) throw std::runtime_error { "Invalid file" };
 
         signature = decodeSignature(signature);
+
+        // Fields are views into signature, only the author information is copied out of it.
+        const codec::SignaturePayload payload { signature.data(), signature.size() };
+        const auto &fields = payload.fields();
+        if (fields.keyFormat == codec::SignaturePayload::KeyFormat::Fingerprint) {
+            // Only the fingerprint is embedded, verify with the parsed key of the trusted key store.
+            key = utils::TrustedKeyStore::getInstance().find(fields.fingerprint);
+            if (key == nullptr) {
+                QMessageBox::information(
+                        this, "Unknown signer",
+                        "Image is signed by a key which is not trusted, verify an image which "
+                        "embeds the public key of the author and trust its key first.");
+                return;
+            }
+        } else {
+            const auto toInteger = [](std::string_view field) {
+                return CryptoPP::Integer { reinterpret_cast<const CryptoPP::byte *>(field.data()),
+                                           field.size() };
+            };
+            pbKey_.Initialize(toInteger(fields.modulus), toInteger(fields.exponent));
+        }
+        author_.authorName = fields.authorName;
+        author_.authorEmail = fields.authorEmail;
+        author_.authorPortFolioURL = fields.authorPortFolioURL;
+
+        CryptoPP::RSASSA_PKCS1v15_SHA_Verifier verifier { *key };
+        const auto signedData = payload.signedData();
+        const auto sign = payload.signature();
+        match = verifier.VerifyMessage(
+                reinterpret_cast<const CryptoPP::byte *>(signedData.data()), signedData.size(),
+                reinterpret_cast<const CryptoPP::byte *>(sign.data()), sign.size());
+        isEmbeddedKey = key == &pbKey_;
     } catch (const std::exception &e) {
         qDebug() << e.what();
         QMessageBox::information(this, "No valid signature found",
@@ -98,42 +122,23 @@ void MainWindow::onVerifyImage()
         return;
     }
 
-    std::uint16_t szData { 0 };
-    int szTotal { 0 };
-    std::string pbKeyData;
-    auto begSignature = reinterpret_cast<const char *>(signature.data());
-    std::istringstream signatureReader{ { begSignature, begSignature + signature.size() } };
-
-    signatureReader.read(reinterpret_cast<char *>(&szData), 2);
-    szTotal += szData + 2;
-    pbKeyData.resize(szData);
-    signatureReader.read(pbKeyData.data(), szData);
-    CryptoPP::StringSource source { pbKeyData, true };
-    pbKey_.BERDecode(source);
-    
-    signatureReader.read(reinterpret_cast<char *>(&szData), 2);
-    szTotal += szData + 2;
-    author_.authorName.resize(szData);
-    signatureReader.read(author_.authorName.data(), szData);
-
-    signatureReader.read(reinterpret_cast<char *>(&szData), 2);
-    szTotal += szData + 2;
-    author_.authorEmail.resize(szData);
-    signatureReader.read(author_.authorEmail.data(), szData);
-    
-    signatureReader.read(reinterpret_cast<char *>(&szData), 2);
-    szTotal += szData + 2;
-    author_.authorPortFolioURL.resize(szData);
-    signatureReader.read(author_.authorPortFolioURL.data(), szData);
-    
-    std::vector<CryptoPP::byte> sign;
-    signatureReader.read(reinterpret_cast<char *>(&szData), 2);
-    sign.resize(szData);
-    signatureReader.read(reinterpret_cast<char *>(sign.data()), sign.size());
-
-    CryptoPP::RSASSA_PKCS1v15_SHA_Verifier verifier { pbKey_ };
-    auto match = verifier.VerifyMessage(reinterpret_cast<CryptoPP::byte *>(signature.data()),
-                                        szTotal, sign.data(), sign.size());
+    // Any image could embed any key, a key is only trusted when the user asks for it. Once trusted,
+    // later images of the author may embed only its fingerprint.
+    auto &trustedKeys = utils::TrustedKeyStore::getInstance();
+    if (match && isEmbeddedKey && !trustedKeys.contains(pbKey_)) {
+        QApplication::restoreOverrideCursor();
+        const auto usrConfirm = QMessageBox::question(
+                this, "Trust this key?",
+                QString { "Image is signed by %1 with a key which is not trusted yet. Trust it, "
+                          "so images of the author which embed only its fingerprint could be "
+                          "verified?" }
+                        .arg(QString::fromStdString(author_.authorName).toHtmlEscaped()));
+        QApplication::setOverrideCursor(Qt::CursorShape::WaitCursor);
+
+        if (usrConfirm == QMessageBox::StandardButton::Yes && !trustedKeys.add(pbKey_))
+            QMessageBox::warning(this, "Unable to trust the key",
+                                 "The key could not be saved into the trusted key directory.");
+    }
 
     std::string message { fmt::format(
             "Name: {}<br>Email: <a href='mailto:{}'>{}</a><br>Portfolio: <a "
@@ -143,8 +148,26 @@ void MainWindow::onVerifyImage()
 
     BOOST_SCOPE_EXIT_ALL(&, this) { ui_->labAuthorInfo->setText(QString::fromStdString(message)); };
 
-    if (!QFile::exists(QString::fromStdString(fmt::format("{}.sign", imagePath_.toStdString()))))
+    if (!QFile::exists(QString::fromStdString(fmt::format("{}.sign", imagePath_.toStdString())))) {
+        // Without its receipt, the image is looked up among the images indexed when they were signed,
+        // it is only unmodified if its nearest indexed image was signed by the key it is verified with.
+        const auto &index = utils::SimilarityIndex::getInstance();
+        if (index.size() == 0) return;
+        try {
+            std::string dmpPbKey;
+            CryptoPP::StringSink pbKeySerializer { dmpPbKey };
+            key->DEREncode(pbKeySerializer);
+            using Payload = codec::SignaturePayload;
+            const auto signer = utils::SimilarityIndex::signerOf(
+                    Payload::fingerprint(dmpPbKey, Payload::shortFingerprintSize));
+            const auto hash = utils::HashCache::getInstance().fingerprintOf(imagePath_).perceptual;
+            const bool isSigned { match && index.isSignedBy(hash.bits(), signer) };
+            message += fmt::format("<br>Modified: {}", isSigned ? "No" : "Yes");
+        } catch (const std::exception &e) {
+            qDebug() << e.what();
+        }
         return;
+    }
 
     std::ifstream readerSignReceipt;
     readerSignReceipt.open(fmt::format("{}.sign", imagePath_.toStdString()), std::ios::in);
@@ -153,27 +176,14 @@ void MainWindow::onVerifyImage()
     std::getline(readerSignReceipt, hash);
     std::getline(readerSignReceipt, hash);
 
-    boost::trim(hash);
-    qDebug() << QString::fromStdString(hash);
-
-    auto argsPHasher = fmt::format("./perceptual_hash.exe \"{}\" --compare \"{}\"",
-                                   imagePath_.toStdString(), hash);
-    bp::ipstream soutPHasher;
-#if defined(WIN32) && !defined(DEBUG)
-    bp::child pHasher { argsPHasher, bp::std_out > soutPHasher, bp::windows::create_no_window };
-#else
-    bp::child pHasher { argsPHasher, bp::std_out > soutPHasher };
-#endif // defined(WIN32) && !defined(DEBUG)
-    pHasher.wait();
-    
-    std::string rsltPHasher;
-    std::getline(soutPHasher, rsltPHasher);
-    boost::trim(rsltPHasher);
-    qDebug() << QString::fromStdString(rsltPHasher);
-
-    message += fmt::format("<br>Modified: {}",
-                           boost::lexical_cast<int>(rsltPHasher) < SimilarityThreashold ? "No"
-                                                                                        : "Yes");
+    try {
+        const auto distance = utils::PerceptualHash::fromHex(hash).distance(
+                utils::HashCache::getInstance().fingerprintOf(imagePath_).perceptual);
+        qDebug() << distance;
+        message += fmt::format("<br>Modified: {}", distance < SimilarityThreashold ? "No" : "Yes");
+    } catch (const std::exception &e) {
+        qDebug() << e.what();
+    }
 
 #ifdef DEBUG
     std::ofstream outDebug;
@@ -209,39 +219,19 @@ void MainWindow::initUI()
 
 std::vector<std::byte> MainWindow::loadDataFromImage()
 {
-    namespace bp = boost::process;
-
-    auto argsSignExtractor = fmt::format("jsteg.exe reveal \"{}\" \"{}.reveal.txt\"",
-                                         imagePath_.toStdString(), imagePath_.toStdString());
-#if defined(WIN32) && !defined(DEBUG)
-    bp::child signExtractor { argsSignExtractor,
-                              boost::process::windows::create_no_window };
-#else
-    bp::child signExtractor { argsSignExtractor };
-#endif // defined(WIN32) && !defined(DEBUG)
-
-    signExtractor.wait();
-
-    std::ifstream reader;
-    reader.open(fmt::format("{}.reveal.txt", imagePath_.toStdString()), std::ios::in);
-    if (!reader.is_open()) throw std::runtime_error { "Invalid file" };
-
-    std::string buffer;
-    std::getline(reader, buffer);
-    std::getline(reader, buffer);
-
-    reader.close();
-    QFile tempFile { QString::fromStdString(
-            fmt::format("{}.reveal.txt", imagePath_.toStdString())) };
-    tempFile.remove();
-
     std::unique_ptr<codec::ICodecFactory> facCodec {
         std::make_unique<codec::DefaultCodecFactory>()
     };
 
-    auto base64Dec = facCodec->createDefaultB2TDecoder(buffer);
-    base64Dec->execute();
-    return base64Dec->getCodecResult();
+    auto extractor = facCodec->createDefaultImageSignExtractor(targetImage_);
+    QFile fileImage { imagePath_ };
+    if (fileImage.open(QIODevice::ReadOnly)) {
+        const auto image = fileImage.readAll();
+        extractor->setCodecData(reinterpret_cast<const std::byte *>(image.constData()),
+                                static_cast<std::size_t>(image.size()));
+    }
+    extractor->execute();
+    return extractor->getCodecResult();
 }
 
 std::vector<std::byte> MainWindow::decodeSignature(const std::vector<std::byte> &signature)
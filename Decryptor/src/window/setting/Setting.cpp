@@ -3,7 +3,10 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
+#include <algorithm>
+#include <array>
 #include <initializer_list>
+#include <iterator>
 #include <numeric>
 #include <QDebug>
 #include <QFile>
@@ -15,6 +18,13 @@
 #include "window/setting/Setting.hpp"
 
 namespace window {
+namespace {
+/**
+ * @brief Key fingerprint size of each option of optKeyFingerprintSize, in order.
+ */
+constexpr std::array<int, 3> keyFingerprintSizes { 0, 16, 32 };
+}
+
 Setting::Setting(QWidget *parent) : QDialog(parent), ui_ { std::make_unique<Ui::settingDialog>() }
 {
     ui_->setupUi(this);
@@ -33,6 +43,11 @@ void Setting::loadConfigs()
 {
     auto configMng = &utils::ConfigManager::getInstance();
     ui_->optEnableHighDPIScaling->setChecked(configMng->isEnableHighDPIScaling());
+    ui_->optWorkerThreads->setValue(configMng->getWorkerThreads());
+    const auto fingerprintSize = std::find(keyFingerprintSizes.begin(), keyFingerprintSizes.end(),
+                                           configMng->getKeyFingerprintSize());
+    ui_->optKeyFingerprintSize->setCurrentIndex(
+            static_cast<int>(std::distance(keyFingerprintSizes.begin(), fingerprintSize)));
 }
 
 void Setting::onBtnCancelClicked()
@@ -45,6 +60,10 @@ void Setting::onBtnOkClicked()
     auto configMng = &utils::ConfigManager::getInstance();
 
     configMng->setEnableHighDPIScaling(ui_->optEnableHighDPIScaling->isChecked());
+    configMng->setWorkerThreads(ui_->optWorkerThreads->value());
+    const auto idxFingerprintSize =
+            static_cast<std::size_t>(ui_->optKeyFingerprintSize->currentIndex());
+    configMng->setKeyFingerprintSize(keyFingerprintSizes.at(idxFingerprintSize));
 
     configMng->dumpConfig();
     QMessageBox::information(this, QStringLiteral("ADSI Encryptor"),
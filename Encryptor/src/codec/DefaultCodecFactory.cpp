@@ -11,6 +11,7 @@
 #include "codec/Base64DecoderCodec.hpp"
 #include "codec/Base64EncoderCodec.hpp"
 #include "codec/DeflateCodec.hpp"
+#include "codec/ImageSignExtractCodec.hpp"
 #include "codec/InflateCodec.hpp"
 #include "codec/RSASignEncoderCodec.hpp"
 #include "codec/SHA3EncoderCodec.hpp"
@@ -104,6 +105,11 @@ std::unique_ptr<ImageSignCodec> DefaultCodecFactory::createDefaultImageSigner(
     return std::make_unique<ImageSignCodec>(std::move(image), pbKey, prKey, author);
 }
 
+std::unique_ptr<ICodec> DefaultCodecFactory::createDefaultImageSignExtractor(QImage image)
+{
+    return std::make_unique<ImageSignExtractCodec>(std::move(image));
+}
+
 void DefaultCodecFactory::setCodecBuffer(CodecDataStream data, ICodec *codec)
 {
     if (std::holds_alternative<ArrayDataType>(data)) {
@@ -125,5 +125,11 @@ struct ICodecFactory
                              const db::data::Author *author) = 0
     {
     }
+    /**
+     * @brief Create codec to extract the signature embedded by the default image signer.
+     * @param image Signed image.
+     * @return Codec which result in the compressed signature of @p image.
+     */
+    virtual std::unique_ptr<ICodec> createDefaultImageSignExtractor(QImage image) = 0 { }
 };
 }
\ No newline at end of file
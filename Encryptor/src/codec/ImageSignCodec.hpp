@@ -6,9 +6,15 @@
 #pragma once
 #include <QImage>
 
+#include <array>
+#include <atomic>
 #include <bitset>
+#include <chrono>
+#include <functional>
+#include <string>
 
 #include "codec/ICodec.hpp"
+#include "codec/WatermarkLayout.hpp"
 #include "db/data/Author.hpp"
 #include "generator/ICryptoKeyGenerator.hpp"
 
@@ -34,11 +40,15 @@ public:
          */
         enum { SHA256 = 0 /**< Determined as SHA265 hash. */ };
     };
+    /**
+     * @brief Minimum interval between two progress updates while embedding.
+     */
+    static constexpr std::chrono::milliseconds progressInterval { 50 };
 
 public:
     /**
      * @brief Create codec and assign required data to the codec.
-     * @param image Image to sign.
+     * @param image Image to sign, move it in to let the codec sign its pixels without copying them.
      * @param pbKey Observer pointer to the public key of the author, must not be nullptr.
      * @param prKey Observer pointer to the private key of the author, must not be nullptr.
      * @param author Observer pointer to the author info of the author, must not be nullptr.
@@ -52,38 +62,93 @@ public:
                             const db::data::Author *author);
     
     /**
-     * @brief Not implemented as QImage can't be described in these form.
-     * @throw std::logic_error if get's called.
+     * @brief Set content of the JPEG file of the image, to sign its quantized coefficients instead of the
+     * pixels.
+     * @param data Content of the JPEG file.
+     */
+    void setCodecData(std::vector<std::byte> data) override;
+    /**
+     * @copydoc setCodecData(std::vector<std::byte>)
+     */
+    void setCodecData(std::string_view data) override;
+    /**
+     * @copydoc setCodecData(std::vector<std::byte>)
+     * @param size Amount of bytes in @p data.
+     * @throw std::invalid_argument if @p data is nullptr.
+     */
+    void setCodecData(const std::byte *data, std::size_t size) override;
+    /**
+     * @brief Sign a JPEG file into another file strip by strip, instead of holding the image in memory.
+     *
+     * Takes precedence over the content of a JPEG file set. Peak memory is bounded by a strip of the image,
+     * the pixels are signed and re-encoded at quality 100 with the sampling and markers of the source. A
+     * progressive file could not be read strip by strip and is rejected by execute(). The image given to
+     * the constructor is not used, and getCodecResult() stays empty.
+     *
+     * @param srcPath Path to the JPEG file to sign, in the local 8-bit encoding.
+     * @param outPath Path to write the signed file to, in the local 8-bit encoding.
+     * @throw std::invalid_argument if @p srcPath or @p outPath is empty.
      */
-    void setCodecData(std::vector<std::byte>) override;
+    void setStreamPaths(std::string srcPath, std::string outPath);
     /**
-     * @brief Not implemented as QImage can't be described in these form.
-     * @throw std::logic_error if get's called.
+     * @brief Replace image to sign, taking ownership of its pixels.
+     *
+     * The pixels are signed in place and handed back by getEncodedImage(), so signing keeps a single pixel
+     * buffer as long as the caller holds no other reference to @p image. Images not in
+     * QImage::Format_ARGB32 are converted first, in place when the depth allows it.
+     *
+     * @param image Image to sign.
      */
-    void setCodecData(std::string_view) override;
+    void setImage(QImage &&image);
     /**
-     * @brief Not implemented as QImage can't be described in these form.
-     * @throw std::logic_error if get's called.
+     * @brief Embed the fingerprint of the public key instead of the key itself.
+     *
+     * Drops about 400 bytes of a 3072 bits key from the payload, so fewer blocks are touched. The verifier
+     * must already trust the key to resolve the fingerprint.
+     *
+     * @param size Size of the fingerprint, codec::SignaturePayload::shortFingerprintSize or
+     * codec::SignaturePayload::fullFingerprintSize, 0 to embed the public key.
+     * @throw std::invalid_argument if @p size is neither 0 nor a fingerprint size.
      */
-    void setCodecData(const std::byte *, std::size_t) override;
+    void setFingerprintSize(std::size_t size);
 
+    /**
+     * @brief Sign the image and embed the compressed signature into it.
+     *
+     * The signature is written as described by codec::WatermarkLayout, prefixed by the header. If content
+     * of a JPEG file is set, the quantized luminance coefficients of the file are signed and written back
+     * losslessly. Otherwise the image is normalized into QImage::Format_ARGB32 and signed in its pixels.
+     * Bands of block rows are embedded in parallel on utils::ThreadPool, progress is reported from the
+     * workers at most once per progressInterval, then once at 100 percent. If stream paths are set, the
+     * file is signed strip by strip instead, see setStreamPaths(std::string, std::string).
+     *
+     * @throw std::length_error if the image is not large enough to hold the signature.
+     * @throw std::domain_error if stream paths are set and the file is stored in multiple scans, such
+     * as a progressive JPEG file.
+     * @throw std::runtime_error if the JPEG file is invalid or could not be written, or cancel() is
+     * called.
+     */
     void execute() override;
+    /**
+     * @brief Request execute() running on another thread to stop before the next block row of each band.
+     */
+    void cancel();
 
     /**
-     * @brief Not implemented as QImage can't be described in these form.
-     * @throw std::logic_error if get's called.
+     * @brief Get signed JPEG file.
+     * @return Content of the signed JPEG file, empty if the pixels are signed.
      */
     const std::vector<std::byte> &getCodecResult() const override;
     
     /**
-     * @brief Construct signature text which compressed with zlib.
-     * @return Zlib compressed signature text.
-    */
+     * @brief Construct signature payload, laid out as described by codec::SignaturePayload.
+     * @return Signature payload, compressed by buildWatermark() before it is embedded.
+     */
     std::vector<std::byte> buildSignatureText();
 
     /**
-     * @brief Get encoded image from the codec.
-     * @return Image encoded by the codec.
+     * @brief Take encoded image out of the codec, the codec hold a null image afterward.
+     * @return Image encoded by the codec, null if the JPEG file is signed or it is already taken.
      */
     virtual QImage getEncodedImage();
     /**
@@ -100,17 +165,107 @@ signals:
 
 private:
     /**
-     * @brief Image to sign
+     * @brief Build the watermark, header followed by the compressed signing receipt.
+     * @return Bytes of the watermark.
+     */
+    std::vector<std::byte> buildWatermark() const;
+    /**
+     * @brief Embed watermark into pixels of the image.
+     * @param watermark Bytes of the watermark.
+     * @throw std::length_error if the image is not large enough to hold @p watermark.
+     */
+    void embedIntoPixels(const std::vector<std::byte> &watermark);
+    /**
+     * @brief Embed watermark into quantized coefficients of the JPEG file.
+     * @param watermark Bytes of the watermark.
+     * @throw std::length_error if the image is not large enough to hold @p watermark.
+     */
+    void embedIntoCoefficients(const std::vector<std::byte> &watermark);
+    /**
+     * @brief Embed watermark into pixels of the JPEG file at the stream paths, strip by strip.
+     * @param watermark Bytes of the watermark.
+     * @throw std::length_error if the image is not large enough to hold @p watermark.
+     */
+    void embedIntoStream(const std::vector<std::byte> &watermark);
+    /**
+     * @brief Get bits of the watermark carried by a block.
+     * @param watermark Bytes of the watermark.
+     * @param idxBlock Index of the block in block row major order.
+     * @return Bits of the block, false past the end of @p watermark.
+     */
+    static std::array<bool, WatermarkLayout::bitsPerBlock>
+    bitsOfBlock(const std::vector<std::byte> &watermark, std::size_t idxBlock);
+    /**
+     * @brief Embed blocks in bands of block rows in parallel, and report progress.
+     * @param col Amount of blocks in a block row.
+     * @param szBlocks Amount of blocks to embed, in block row major order from the first block.
+     * @param embed Function which embed a block given its column, row and index.
+     * @throw std::runtime_error if cancel() is called.
+     */
+    void embedInBands(int col, std::size_t szBlocks,
+                      const std::function<void(int, int, std::size_t)> &embed);
+    /**
+     * @brief Embed bits into a block of pixels, compress its range first if embedding would clamp.
+     * @param origin Top left pixel of the block, in QImage::Format_ARGB32.
+     * @param bytesPerLine Amount of bytes between two scanlines.
+     * @param bits Bits to embed, in the order of WatermarkLayout::positions.
+     */
+    static void signBlock(uchar *origin, std::ptrdiff_t bytesPerLine,
+                          const std::array<bool, WatermarkLayout::bitsPerBlock> &bits);
+    /**
+     * @brief Embed bits into a block of the encoded image.
+     * @param origin Top left pixel of the block, in QImage::Format_ARGB32.
+     * @param bytesPerLine Amount of bytes between two scanlines.
+     * @param bits Bits to embed, in the order of WatermarkLayout::positions.
+     * @return False if a sample got clamped, the bits may not be readable in that case.
+     */
+    static bool embedBlock(uchar *origin, std::ptrdiff_t bytesPerLine,
+                           const std::array<bool, WatermarkLayout::bitsPerBlock> &bits);
+    /**
+     * @brief Scale samples of a block of the encoded image into [WatermarkLayout::margin, 255 -
+     * WatermarkLayout::margin].
+     * @param origin Top left pixel of the block, in QImage::Format_ARGB32.
+     * @param bytesPerLine Amount of bytes between two scanlines.
+     */
+    static void compressBlockRange(uchar *origin, std::ptrdiff_t bytesPerLine);
+
+private:
+    /**
+     * @brief Image to sign, moved into @p encoded_ by execute().
      */
     QImage buffer_;
     /**
      * @brief Signed image.
      */
     QImage encoded_;
+    /**
+     * @brief Content of the JPEG file to sign, empty to sign the pixels.
+     */
+    std::vector<std::byte> jpeg_;
+    /**
+     * @brief Content of the signed JPEG file.
+     */
+    std::vector<std::byte> encodedJPEG_;
+    /**
+     * @brief Path to the JPEG file to sign strip by strip, empty if not streaming.
+     */
+    std::string streamSrcPath_;
+    /**
+     * @brief Path to write the file signed strip by strip to.
+     */
+    std::string streamOutPath_;
+    /**
+     * @brief Size of the embedded fingerprint of the public key, 0 to embed the public key.
+     */
+    std::size_t fingerprintSize_ { 0 };
     /**
      * @brief Signing receipt of the signed image
      */
     std::vector<std::byte> signingReceipt_;
+    /**
+     * @brief Determine if execute() should stop.
+     */
+    std::atomic<bool> cancelled_ { false };
     /**
      * @brief Observer pointer to author's public key.
      */
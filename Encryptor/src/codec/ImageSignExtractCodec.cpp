@@ -0,0 +1,160 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <cstdint>
+#include <stdexcept>
+
+#include <boost/range/irange.hpp>
+
+#include "codec/ImageSignExtractCodec.hpp"
+#include "utils/BlockDCT.hpp"
+
+namespace codec {
+ImageSignExtractCodec::ImageSignExtractCodec(QImage image) : buffer_ { std::move(image) } { }
+
+void ImageSignExtractCodec::setCodecData(std::vector<std::byte> data)
+{
+    jpeg_ = std::move(data);
+}
+
+void ImageSignExtractCodec::setCodecData(std::string_view data)
+{
+    auto begData = reinterpret_cast<const std::byte *>(data.data());
+    jpeg_.assign(begData, begData + data.size());
+}
+
+void ImageSignExtractCodec::setCodecData(const std::byte *data, std::size_t size)
+{
+    if (data == nullptr)
+        throw std::invalid_argument { "Parameter data must not be nullptr but it seems to be." };
+
+    jpeg_.assign(data, data + size);
+}
+
+void ImageSignExtractCodec::execute()
+{
+    decoded_.clear();
+    coefficients_.reset();
+
+    if (!jpeg_.empty()) {
+        try {
+            coefficients_ = std::make_unique<utils::JPEGCoefficients>(jpeg_);
+            extract();
+            return;
+        } catch (const std::runtime_error &) {
+            // The file may have been re-encoded after signed, the pixels could still carry it.
+            coefficients_.reset();
+            decoded_.clear();
+            if (buffer_.isNull()) throw;
+        }
+    }
+
+    if (buffer_.format() != QImage::Format_ARGB32)
+        buffer_ = buffer_.convertToFormat(QImage::Format_ARGB32);
+    extract();
+}
+
+const std::vector<std::byte> &ImageSignExtractCodec::getCodecResult() const
+{
+    return decoded_;
+}
+
+void ImageSignExtractCodec::extract()
+{
+    using Layout = WatermarkLayout;
+
+    const std::size_t szBytes { blockColumns() * blockRows() * Layout::bitsPerBlock / 8 };
+    if (szBytes < Layout::headerSize) throw std::runtime_error { "No signature found" };
+
+    // Magic is checked on its own first, an unsigned image is rejected after a handful of blocks.
+    // The cursor carries the last block over to the next read, no block is transformed twice.
+    BlockCursor cursor;
+    std::vector<std::byte> header;
+    header.reserve(Layout::headerSize);
+    readBytes(0, Layout::magic.size(), header, cursor);
+    for (auto idx : boost::irange(Layout::magic.size())) {
+        if (static_cast<std::uint8_t>(header[idx]) != Layout::magic[idx])
+            throw std::runtime_error { "No signature found" };
+    }
+
+    readBytes(Layout::magic.size(), Layout::headerSize - Layout::magic.size(), header, cursor);
+    if (static_cast<std::uint8_t>(header[Layout::magic.size()]) != Layout::version)
+        throw std::runtime_error { "Unsupported signature version" };
+
+    std::uint32_t szPayload { 0 };
+    const std::size_t begLength { Layout::headerSize - Layout::lengthSize };
+    for (auto idx : boost::irange(Layout::lengthSize))
+        szPayload |= static_cast<std::uint32_t>(header[begLength + idx]) << (idx * 8);
+    if (szPayload == 0 || szPayload > szBytes - Layout::headerSize)
+        throw std::runtime_error { "No signature found" };
+
+    decoded_.reserve(szPayload);
+    readBytes(Layout::headerSize, szPayload, decoded_, cursor);
+}
+
+std::size_t ImageSignExtractCodec::blockColumns() const
+{
+    if (coefficients_) return static_cast<std::size_t>(coefficients_->blockColumns());
+    return static_cast<std::size_t>(buffer_.width() / WatermarkLayout::blockSize);
+}
+
+std::size_t ImageSignExtractCodec::blockRows() const
+{
+    if (coefficients_) return static_cast<std::size_t>(coefficients_->blockRows());
+    return static_cast<std::size_t>(buffer_.height() / WatermarkLayout::blockSize);
+}
+
+void ImageSignExtractCodec::readBytes(std::size_t offset, std::size_t count,
+                                      std::vector<std::byte> &bytes, BlockCursor &cursor) const
+{
+    using Layout = WatermarkLayout;
+    const std::size_t col { blockColumns() };
+
+    auto &[idxBlock, bits] = cursor;
+    for (auto idxByte : boost::irange(offset, offset + count)) {
+        std::uint8_t value { 0 };
+        for (auto idx : boost::irange(8)) {
+            const std::size_t idxBit { idxByte * 8 + idx };
+            if (idxBit / Layout::bitsPerBlock != idxBlock) {
+                idxBlock = idxBit / Layout::bitsPerBlock;
+                extractBlock(static_cast<int>(idxBlock % col), static_cast<int>(idxBlock / col),
+                             bits);
+            }
+            value |= bits[idxBit % Layout::bitsPerBlock] << idx;
+        }
+        bytes.push_back(static_cast<std::byte>(value));
+    }
+}
+
+void ImageSignExtractCodec::extractBlock(
+        int col, int row, std::array<bool, WatermarkLayout::bitsPerBlock> &bits) const
+{
+    using Layout = WatermarkLayout;
+    constexpr int szBlock { Layout::blockSize };
+
+    if (coefficients_) {
+        auto block = coefficients_->block(col, row);
+        for (auto idx : boost::irange(Layout::bitsPerBlock)) {
+            const auto &[posX, posY] = Layout::positions[idx];
+            bits[idx] = Layout::bitOfQuantized(block[posY * szBlock + posX]);
+        }
+        return;
+    }
+
+    utils::BlockDCT::Block samples;
+    for (int y = 0; y < szBlock; y++) {
+        auto line = reinterpret_cast<const QRgb *>(buffer_.constScanLine(row * szBlock + y))
+                + col * szBlock;
+        for (int x = 0; x < szBlock; x++) samples[y * szBlock + x] = Layout::luma(line[x]);
+    }
+
+    utils::BlockDCT::Block coefficients;
+    utils::BlockDCT {}.transform(samples, coefficients);
+    for (auto idx : boost::irange(Layout::bitsPerBlock)) {
+        const auto &[posX, posY] = Layout::positions[idx];
+        bits[idx] = Layout::bitOf(coefficients[posY * szBlock + posX]);
+    }
+}
+}
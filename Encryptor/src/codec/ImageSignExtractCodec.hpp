@@ -0,0 +1,130 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QImage>
+
+#include <array>
+#include <limits>
+#include <memory>
+
+#include "codec/ICodec.hpp"
+#include "codec/WatermarkLayout.hpp"
+#include "utils/JPEGCoefficients.hpp"
+
+namespace codec {
+/**
+ * @brief Codec to extract the signature embedded by codec::ImageSignCodec.
+ *
+ * Bits are read straight from the luminance coefficients of the decoded image as described by
+ * codec::WatermarkLayout, or from the quantized coefficients of its JPEG file. The result is the
+ * compressed signature without its header. Only the blocks which hold the header and the payload are
+ * read, so the cost does not grow with the image.
+ */
+class ImageSignExtractCodec : public ICodec
+{
+public:
+    /**
+     * @brief Create codec with image to extract from.
+     * @param image Signed image, may be null if the JPEG file is set.
+     */
+    explicit ImageSignExtractCodec(QImage image);
+
+    /**
+     * @brief Set content of the JPEG file of the image, to extract from its quantized coefficients first.
+     * @param data Content of the JPEG file.
+     */
+    void setCodecData(std::vector<std::byte> data) override;
+    /**
+     * @copydoc setCodecData(std::vector<std::byte>)
+     */
+    void setCodecData(std::string_view data) override;
+    /**
+     * @copydoc setCodecData(std::vector<std::byte>)
+     * @param size Amount of bytes in @p data.
+     * @throw std::invalid_argument if @p data is nullptr.
+     */
+    void setCodecData(const std::byte *data, std::size_t size) override;
+
+    /**
+     * @copydoc codec::ICodec::execute()
+     *
+     * If content of a JPEG file is set, the signature is read from its quantized coefficients, then from
+     * the pixels of the image if the file does not carry one.
+     *
+     * @throw std::runtime_error if the image does not carry a signature, or carry a signature of
+     * unsupported version.
+     */
+    void execute() override;
+
+    const std::vector<std::byte> &getCodecResult() const override;
+
+private:
+    /**
+     * @brief Extract the payload from the pixels, or the coefficients if they are loaded.
+     * @throw std::runtime_error if no signature is found.
+     */
+    void extract();
+    /**
+     * @brief Amount of blocks in a block row which carry the watermark.
+     */
+    std::size_t blockColumns() const;
+    /**
+     * @brief Amount of block rows which carry the watermark.
+     */
+    std::size_t blockRows() const;
+    /**
+     * @brief Last block read from the watermark, kept between reads of consecutive ranges.
+     */
+    struct BlockCursor
+    {
+        /**
+         * @brief Index of the block in block row major order, out of range before any read.
+         */
+        std::size_t index { std::numeric_limits<std::size_t>::max() };
+        /**
+         * @brief Bits of the block.
+         */
+        std::array<bool, WatermarkLayout::bitsPerBlock> bits {};
+    };
+    /**
+     * @brief Read bytes of the watermark, transforming only the blocks which hold them.
+     *
+     * A block shared with the previous read through @p cursor is not transformed again.
+     * @param offset Offset of the first byte in the watermark.
+     * @param count Amount of bytes to read.
+     * @param bytes Array to append the bytes to.
+     * @param cursor Last block read, updated with the last block of this read.
+     */
+    void readBytes(std::size_t offset, std::size_t count, std::vector<std::byte> &bytes,
+                   BlockCursor &cursor) const;
+    /**
+     * @brief Read the bits of a block of the image.
+     * @param col Column of the block.
+     * @param row Row of the block.
+     * @param bits Extracted bits, in the order of WatermarkLayout::positions.
+     */
+    void extractBlock(int col, int row,
+                      std::array<bool, WatermarkLayout::bitsPerBlock> &bits) const;
+
+private:
+    /**
+     * @brief Image to extract from.
+     */
+    QImage buffer_;
+    /**
+     * @brief Content of the JPEG file of the image, empty to extract from the pixels only.
+     */
+    std::vector<std::byte> jpeg_;
+    /**
+     * @brief Coefficients of @p jpeg_ while extracting from them.
+     */
+    std::unique_ptr<utils::JPEGCoefficients> coefficients_;
+    /**
+     * @brief Extracted signature.
+     */
+    std::vector<std::byte> decoded_;
+};
+}
@@ -0,0 +1,212 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <stdexcept>
+
+#include "codec/SHA3EncoderCodec.hpp"
+#include "codec/SignaturePayload.hpp"
+
+namespace codec {
+namespace {
+/**
+ * @brief Get size of a varint.
+ * @param value Value of the varint.
+ * @return Size in bytes.
+ */
+std::size_t varintSize(std::size_t value)
+{
+    std::size_t result { 1 };
+    for (; value >= 0x80; value >>= 7) result++;
+    return result;
+}
+
+/**
+ * @brief Get size of a field with its length.
+ * @param size Size of the field.
+ * @return Size in bytes.
+ */
+std::size_t fieldSize(std::size_t size)
+{
+    return varintSize(size) + size;
+}
+
+/**
+ * @brief Append a varint to a buffer.
+ * @param buffer Buffer to append to.
+ * @param value Value to append.
+ */
+void writeVarint(std::vector<std::byte> &buffer, std::size_t value)
+{
+    for (; value >= 0x80; value >>= 7)
+        buffer.push_back(static_cast<std::byte>((value & 0x7f) | 0x80));
+    buffer.push_back(static_cast<std::byte>(value));
+}
+
+/**
+ * @brief Append a field with its length to a buffer.
+ * @param buffer Buffer to append to.
+ * @param data Content of the field.
+ * @param size Size of the field.
+ */
+void writeField(std::vector<std::byte> &buffer, const void *data, std::size_t size)
+{
+    writeVarint(buffer, size);
+    auto begin = static_cast<const std::byte *>(data);
+    buffer.insert(buffer.end(), begin, begin + size);
+}
+
+/**
+ * @brief Check if a size is the size of a fingerprint.
+ * @param size Size to check.
+ * @return True if @p size is a fingerprint size.
+ */
+bool isFingerprintSize(std::size_t size)
+{
+    return size == SignaturePayload::shortFingerprintSize
+            || size == SignaturePayload::fullFingerprintSize;
+}
+
+/**
+ * @brief Cursor over a payload which throws instead of reading past its end.
+ */
+class Reader
+{
+public:
+    Reader(const std::byte *begin, const std::byte *end) : current_ { begin }, end_ { end } { }
+
+    std::uint8_t readByte()
+    {
+        if (current_ == end_) throw std::runtime_error { "Signature payload is truncated." };
+        return static_cast<std::uint8_t>(*current_++);
+    }
+
+    std::size_t readVarint()
+    {
+        std::size_t result { 0 };
+        for (std::size_t idx = 0; idx < SignaturePayload::maxVarintSize; idx++) {
+            const auto part = readByte();
+            result |= static_cast<std::size_t>(part & 0x7f) << (idx * 7);
+            if ((part & 0x80) == 0) return result;
+        }
+        throw std::runtime_error { "Signature payload has an invalid length." };
+    }
+
+    std::string_view readField()
+    {
+        const auto size = readVarint();
+        if (size > static_cast<std::size_t>(end_ - current_))
+            throw std::runtime_error { "Signature payload is truncated." };
+
+        std::string_view result { reinterpret_cast<const char *>(current_), size };
+        current_ += size;
+        return result;
+    }
+
+    const std::byte *current() const { return current_; }
+    bool atEnd() const { return current_ == end_; }
+
+private:
+    const std::byte *current_;
+    const std::byte *end_;
+};
+}
+
+std::string SignaturePayload::fingerprint(std::string_view derPublicKey, std::size_t size)
+{
+    if (!isFingerprintSize(size))
+        throw std::invalid_argument { "Parameter size is not the size of a fingerprint." };
+
+    SHA3EncoderCodec hasher { derPublicKey };
+    hasher.execute();
+    const auto &digest = hasher.getCodecResult();
+    return { reinterpret_cast<const char *>(digest.data()), size };
+}
+
+std::size_t SignaturePayload::size(const Fields &fields, std::size_t szSignature)
+{
+    const auto szKey = fields.keyFormat == KeyFormat::Fingerprint
+            ? fieldSize(fields.fingerprint.size())
+            : fieldSize(fields.modulus.size()) + fieldSize(fields.exponent.size());
+    return sizeof(version) + sizeof(KeyFormat) + szKey + fieldSize(fields.authorName.size())
+            + fieldSize(fields.authorEmail.size()) + fieldSize(fields.authorPortFolioURL.size())
+            + fieldSize(szSignature);
+}
+
+std::vector<std::byte> SignaturePayload::writeSigned(const Fields &fields, std::size_t szSignature)
+{
+    if (fields.keyFormat == KeyFormat::Fingerprint && !isFingerprintSize(fields.fingerprint.size()))
+        throw std::invalid_argument { "Fingerprint is not of the size of a fingerprint." };
+
+    std::vector<std::byte> result;
+    result.reserve(size(fields, szSignature));
+
+    result.push_back(static_cast<std::byte>(version));
+    result.push_back(static_cast<std::byte>(fields.keyFormat));
+    if (fields.keyFormat == KeyFormat::Fingerprint) {
+        writeField(result, fields.fingerprint.data(), fields.fingerprint.size());
+    } else {
+        writeField(result, fields.modulus.data(), fields.modulus.size());
+        writeField(result, fields.exponent.data(), fields.exponent.size());
+    }
+    for (auto field : { fields.authorName, fields.authorEmail, fields.authorPortFolioURL })
+        writeField(result, field.data(), field.size());
+
+    return result;
+}
+
+void SignaturePayload::appendSignature(std::vector<std::byte> &payload, const std::byte *signature,
+                                       std::size_t szSignature)
+{
+    if (payload.size() + fieldSize(szSignature) > payload.capacity())
+        throw std::length_error { "Signature is larger than the space reserved for it." };
+
+    writeField(payload, signature, szSignature);
+}
+
+SignaturePayload::SignaturePayload(const std::byte *data, std::size_t size)
+{
+    Reader reader { data, data + size };
+    if (reader.readByte() != version)
+        throw std::runtime_error { "Signature payload is of an unsupported version." };
+
+    fields_.keyFormat = static_cast<KeyFormat>(reader.readByte());
+    switch (fields_.keyFormat) {
+    case KeyFormat::PublicKey:
+        fields_.modulus = reader.readField();
+        fields_.exponent = reader.readField();
+        break;
+    case KeyFormat::Fingerprint:
+        fields_.fingerprint = reader.readField();
+        if (!isFingerprintSize(fields_.fingerprint.size()))
+            throw std::runtime_error { "Signature payload has an invalid fingerprint." };
+        break;
+    default:
+        throw std::runtime_error { "Signature payload has an unknown key format." };
+    }
+    fields_.authorName = reader.readField();
+    fields_.authorEmail = reader.readField();
+    fields_.authorPortFolioURL = reader.readField();
+    signedData_ = { reinterpret_cast<const char *>(data),
+                    static_cast<std::size_t>(reader.current() - data) };
+    signature_ = reader.readField();
+
+    if (!reader.atEnd()) throw std::runtime_error { "Signature payload has trailing bytes." };
+}
+
+const SignaturePayload::Fields &SignaturePayload::fields() const
+{
+    return fields_;
+}
+
+std::string_view SignaturePayload::signedData() const
+{
+    return signedData_;
+}
+
+std::string_view SignaturePayload::signature() const
+{
+    return signature_;
+}
+}
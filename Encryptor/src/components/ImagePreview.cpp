@@ -3,11 +3,14 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
+#include <QGuiApplication>
 #include <QResizeEvent>
+#include <QScreen>
 
 #include <stdexcept>
 
 #include "components/ImagePreview.hpp"
+#include "utils/ScaledImageReader.hpp"
 
 namespace components {
 ImagePreview::ImagePreview(QWidget *parent) : QLabel(parent) { }
@@ -20,6 +23,13 @@ ImagePreview::ImagePreview(const QImage *image, QWidget *parent) : QLabel(parent
     setPreviewImage();
 }
 
+QImage ImagePreview::load(const QString &path)
+{
+    const auto screen = QGuiApplication::primaryScreen();
+    const auto szScreen = screen->size() * screen->devicePixelRatio();
+    return utils::ScaledImageReader::read(path, szScreen);
+}
+
 void ImagePreview::setImage(const QImage *image)
 {
     image_ = image;
@@ -6,6 +6,7 @@
 #pragma once
 #include <QLabel>
 #include <QImage>
+#include <QString>
 
 namespace components {
 /**
@@ -27,6 +28,17 @@ public:
      */
     explicit ImagePreview(const QImage *image, QWidget *parent = nullptr);
 
+    /**
+     * @brief Load image file at the resolution a preview needs.
+     *
+     * The image is scaled down as long as it still covers the screen, JPEG files are decoded scaled by
+     * libjpeg instead of being decoded whole and smooth scaled.
+     *
+     * @param path Path to the image.
+     * @return Loaded image, null if the file could not be read.
+     */
+    static QImage load(const QString &path);
+
 public: // Setter
     /**
      * @brief Set image to preview.
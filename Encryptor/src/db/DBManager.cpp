@@ -6,6 +6,8 @@
  *********************************************************************************************************************/
 #include <QDebug>
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
 
 #include "db/DBManager.hpp"
@@ -82,5 +84,55 @@ std::optional<data::KeyStore> DBManager::getAuthorKeyByDistance(std::uint32_t au
                                                 limit(1, offset(distance)));
     return key.empty() ? std::nullopt : std::make_optional(*key.begin());
 }
+
+std::vector<std::uint32_t>
+DBManager::insertSignedImages(const std::vector<data::SignedImage> &images)
+{
+    std::vector<std::uint32_t> ids;
+    ids.reserve(images.size());
+    storage_.transaction([&] {
+        for (const auto &image : images)
+            ids.push_back(static_cast<std::uint32_t>(storage_.insert(image)));
+        return true;
+    });
+    return ids;
+}
+
+std::vector<data::SignedImage>
+DBManager::getSignedImagesByDigest(const std::vector<std::string> &digests)
+{
+    using namespace sqlite_orm;
+    std::vector<data::SignedImage> images;
+    for (std::size_t first = 0; first < digests.size(); first += lookupBatchSize) {
+        const std::vector<std::string> batch {
+            digests.begin() + first,
+            digests.begin() + std::min(first + lookupBatchSize, digests.size())
+        };
+        auto found = storage_.get_all<data::SignedImage>(
+                where(in(&data::SignedImage::contentDigest, batch)));
+        std::move(found.begin(), found.end(), std::back_inserter(images));
+    }
+    std::sort(images.begin(), images.end(),
+              [](const auto &lhs, const auto &rhs) { return lhs.imageID < rhs.imageID; });
+    return images;
 }
 
+std::vector<data::SignedImage>
+DBManager::getSignedImagesByPerceptualHash(const std::vector<std::uint64_t> &hashes)
+{
+    using namespace sqlite_orm;
+    std::vector<data::SignedImage> images;
+    for (std::size_t first = 0; first < hashes.size(); first += lookupBatchSize) {
+        // Hashes are stored as signed integers, the only integers SQLite has.
+        std::vector<std::int64_t> batch(std::min(lookupBatchSize, hashes.size() - first));
+        std::transform(hashes.begin() + first, hashes.begin() + first + batch.size(), batch.begin(),
+                       [](std::uint64_t hash) { return static_cast<std::int64_t>(hash); });
+        auto found = storage_.get_all<data::SignedImage>(
+                where(in(&data::SignedImage::perceptualHash, batch)));
+        std::move(found.begin(), found.end(), std::back_inserter(images));
+    }
+    std::sort(images.begin(), images.end(),
+              [](const auto &lhs, const auto &rhs) { return lhs.imageID < rhs.imageID; });
+    return images;
+}
+}
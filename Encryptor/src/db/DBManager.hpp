@@ -5,12 +5,15 @@
  *********************************************************************************************************************/
 #pragma once
 #include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <sqlite_orm/sqlite_orm.h>
 
 #include "db/data/Author.hpp"
 #include "db/data/KeyStore.hpp"
+#include "db/data/SignedImage.hpp"
 
 namespace db {
 /**
@@ -33,6 +36,8 @@ public:
 
         return make_storage(
                 "usrdata.db",
+                make_index("idx_SignedImage_contentDigest", &data::SignedImage::contentDigest),
+                make_index("idx_SignedImage_perceptualHash", &data::SignedImage::perceptualHash),
                 make_table("Author",
                            make_column("authorID", &data::Author::authorID, primary_key(),
                                        autoincrement()),
@@ -46,7 +51,16 @@ public:
                            make_column("keyParams", &data::KeyStore::keyParams),
                            make_column("keyPasswordHash", &data::KeyStore::keyPasswordHash),
                            foreign_key(&data::KeyStore::authorID)
-                                   .references(&data::Author::authorID)));
+                                   .references(&data::Author::authorID)),
+                make_table("SignedImage",
+                           make_column("imageID", &data::SignedImage::imageID, primary_key(),
+                                       autoincrement()),
+                           make_column("contentDigest", &data::SignedImage::contentDigest),
+                           make_column("perceptualHash", &data::SignedImage::perceptualHash),
+                           make_column("signingReceipt", &data::SignedImage::signingReceipt),
+                           make_column("authorID", &data::SignedImage::authorID),
+                           make_column("keyID", &data::SignedImage::keyID),
+                           make_column("signedAt", &data::SignedImage::signedAt)));
     }
 
     /**
@@ -132,10 +146,35 @@ public:
      * @return Author's key at specified distance, std::nullopt if no key found.
      */
     std::optional<data::KeyStore> getAuthorKeyByDistance(std::uint32_t authorID, std::uint32_t distance);
+    /**
+     * @brief Insert signed images into database, within a single transaction.
+     * @param images Signed images to insert.
+     * @return Index of each signed image record newly created, in the order of @p images.
+     */
+    std::vector<std::uint32_t> insertSignedImages(const std::vector<data::SignedImage> &images);
+    /**
+     * @brief Get signed images by the digests of their content.
+     * @param digests Hex encoded SHA-256 digests of the signed files.
+     * @return Signed images which have one of @p digests, ordered by id.
+     */
+    std::vector<data::SignedImage> getSignedImagesByDigest(const std::vector<std::string> &digests);
+    /**
+     * @brief Get signed images by their perceptual hashes.
+     * @param hashes Bits of the perceptual hashes of the source images.
+     * @return Signed images which have one of @p hashes, ordered by id.
+     */
+    std::vector<data::SignedImage>
+    getSignedImagesByPerceptualHash(const std::vector<std::uint64_t> &hashes);
 
 private:
     DBManager() {};
 
+private:
+    /**
+     * @brief Largest amount of values bound to a single lookup, below the limit of SQLite on bound variables.
+     */
+    static constexpr std::size_t lookupBatchSize { 500 };
+
 private:
     /**
      * @brief SQLite3 database connection hook.
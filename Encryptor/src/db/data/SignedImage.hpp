@@ -0,0 +1,73 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace db::data {
+/**
+ * @brief SignedImage table of the database.
+ *
+ * This table is the ledger of the images signed, it holds what the signing receipt next to the signed file holds,
+ * so an image could be found by the digest of its content or by its perceptual hash. Author and key are kept by
+ * ID only, so the ledger outlive the removal of a key.
+ */
+struct SignedImage
+{
+    SignedImage() { }
+    /**
+     * @brief Construct SignedImage entry to insert into database. Image ID will be given automatically.
+     * @param contentDigest Hex encoded SHA-256 digest of the signed file.
+     * @param perceptualHash Bits of the perceptual hash of the source image.
+     * @param signingReceipt Receipt built by the signer.
+     * @param authorID Unique ID of the author referenced as db::data::Author.
+     * @param keyID Unique ID of the key referenced as db::data::KeyStore.
+     * @param signedAt Milliseconds since epoch at which the image is signed.
+     */
+    SignedImage(std::string contentDigest, std::uint64_t perceptualHash,
+                std::vector<char> signingReceipt, std::uint32_t authorID, std::uint32_t keyID,
+                std::int64_t signedAt)
+        : imageID { -1u },
+          contentDigest { std::move(contentDigest) },
+          perceptualHash { static_cast<std::int64_t>(perceptualHash) },
+          signingReceipt { std::move(signingReceipt) },
+          authorID { authorID },
+          keyID { keyID },
+          signedAt { signedAt }
+    {
+    }
+
+    /**
+     * @brief Unique ID of the data column.
+     */
+    std::uint32_t imageID;
+    /**
+     * @brief Hex encoded SHA-256 digest of the signed file.
+     */
+    std::string contentDigest;
+    /**
+     * @brief Bits of utils::PerceptualHash of the source image, SQLite integers are signed.
+     */
+    std::int64_t perceptualHash;
+    /**
+     * @brief Receipt built by the signer.
+     */
+    std::vector<char> signingReceipt;
+    /**
+     * @brief Unique ID of the author represented in db::data::Author table.
+     */
+    std::uint32_t authorID;
+    /**
+     * @brief Unique ID of the key represented in db::data::KeyStore table.
+     */
+    std::uint32_t keyID;
+    /**
+     * @brief Milliseconds since epoch at which the image is signed, in UTC.
+     */
+    std::int64_t signedAt;
+};
+}
@@ -0,0 +1,195 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <stdexcept>
+
+#include "utils/BatchDCT.hpp"
+#include "utils/BatchDCTKernel.hpp"
+#include "utils/CPUFeatures.hpp"
+
+namespace utils {
+namespace batch_dct {
+namespace {
+/**
+ * @brief Vector operations of the portable kernel, a vector is a plain array of lanes.
+ */
+struct ScalarOps
+{
+    struct Vec
+    {
+        float lane[lanes];
+    };
+
+    static Vec load(const float *src)
+    {
+        Vec rslt;
+        for (std::size_t idx = 0; idx < lanes; idx++) rslt.lane[idx] = src[idx];
+        return rslt;
+    }
+
+    static void store(float *dst, const Vec &value)
+    {
+        for (std::size_t idx = 0; idx < lanes; idx++) dst[idx] = value.lane[idx];
+    }
+
+    static Vec broadcast(float value)
+    {
+        Vec rslt;
+        for (auto &lane : rslt.lane) lane = value;
+        return rslt;
+    }
+
+    static Vec zero() { return broadcast(0.f); }
+
+    static Vec fmadd(const Vec &lhs, const Vec &rhs, const Vec &addend)
+    {
+        Vec rslt;
+        for (std::size_t idx = 0; idx < lanes; idx++)
+            rslt.lane[idx] = lhs.lane[idx] * rhs.lane[idx] + addend.lane[idx];
+        return rslt;
+    }
+};
+}
+
+void forwardScalar(const float *basis, const float *input, float *output)
+{
+    forward<ScalarOps>(basis, input, output);
+}
+
+void inverseScalar(const float *basis, const float *input, float *output)
+{
+    inverse<ScalarOps>(basis, input, output);
+}
+}
+
+BatchDCT::BatchDCT() : BatchDCT(detectBackend()) { }
+
+BatchDCT::BatchDCT(Backend backend) : backend_ { backend }
+{
+    if (!isSupported(backend))
+        throw std::invalid_argument { "Selected DCT kernel is not supported by the CPU." };
+
+    switch (backend) {
+    case Backend::Scalar:
+        forward_ = &batch_dct::forwardScalar;
+        inverse_ = &batch_dct::inverseScalar;
+        break;
+#ifdef ADSI_ARCH_X86
+    case Backend::SSE2:
+        forward_ = &batch_dct::forwardSSE2;
+        inverse_ = &batch_dct::inverseSSE2;
+        break;
+    case Backend::AVX2:
+        forward_ = &batch_dct::forwardAVX2;
+        inverse_ = &batch_dct::inverseAVX2;
+        break;
+    case Backend::AVX512:
+        forward_ = &batch_dct::forwardAVX512;
+        inverse_ = &batch_dct::inverseAVX512;
+        break;
+#endif // ADSI_ARCH_X86
+    default:
+        throw std::invalid_argument { "Selected DCT kernel is not supported by the CPU." };
+    }
+}
+
+BatchDCT::Backend BatchDCT::detectBackend()
+{
+    for (auto backend : { Backend::AVX512, Backend::AVX2, Backend::SSE2 }) {
+        if (isSupported(backend)) return backend;
+    }
+    return Backend::Scalar;
+}
+
+bool BatchDCT::isSupported(Backend backend)
+{
+    const auto &features = CPUFeatures::getInstance();
+    switch (backend) {
+    case Backend::Scalar:
+        return true;
+    case Backend::SSE2:
+        return features.hasSSE2();
+    case Backend::AVX2:
+        return features.hasAVX2();
+    case Backend::AVX512:
+        return features.hasAVX512();
+    }
+    return false;
+}
+
+std::string_view BatchDCT::nameOf(Backend backend)
+{
+    switch (backend) {
+    case Backend::Scalar:
+        return "scalar";
+    case Backend::SSE2:
+        return "sse2";
+    case Backend::AVX2:
+        return "avx2";
+    case Backend::AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+void BatchDCT::interleave(const BlockDCT::Block *blocks, Batch &batch)
+{
+    for (std::size_t lane = 0; lane < batchSize; lane++) {
+        for (std::size_t idx = 0; idx < BlockDCT::blockArea; idx++)
+            batch[idx * batchSize + lane] = blocks[lane][idx];
+    }
+}
+
+void BatchDCT::deinterleave(const Batch &batch, BlockDCT::Block *blocks)
+{
+    for (std::size_t lane = 0; lane < batchSize; lane++) {
+        for (std::size_t idx = 0; idx < BlockDCT::blockArea; idx++)
+            blocks[lane][idx] = batch[idx * batchSize + lane];
+    }
+}
+
+void BatchDCT::transform(const Batch &input, Batch &output) const
+{
+    forward_(BlockDCT::basis().data(), input.data(), output.data());
+}
+
+void BatchDCT::itransform(const Batch &input, Batch &output) const
+{
+    inverse_(BlockDCT::basis().data(), input.data(), output.data());
+}
+
+void BatchDCT::transformBlocks(BlockDCT::Block *blocks, std::size_t count) const
+{
+    alignas(64) Batch batch;
+    std::size_t idx { 0 };
+    for (; idx + batchSize <= count; idx += batchSize) {
+        interleave(blocks + idx, batch);
+        transform(batch, batch);
+        deinterleave(batch, blocks + idx);
+    }
+
+    BlockDCT kernel;
+    for (; idx < count; idx++) kernel.transform(blocks[idx], blocks[idx]);
+}
+
+void BatchDCT::itransformBlocks(BlockDCT::Block *blocks, std::size_t count) const
+{
+    alignas(64) Batch batch;
+    std::size_t idx { 0 };
+    for (; idx + batchSize <= count; idx += batchSize) {
+        interleave(blocks + idx, batch);
+        itransform(batch, batch);
+        deinterleave(batch, blocks + idx);
+    }
+
+    BlockDCT kernel;
+    for (; idx < count; idx++) kernel.itransform(blocks[idx], blocks[idx]);
+}
+
+BatchDCT::Backend BatchDCT::backend() const
+{
+    return backend_;
+}
+}
@@ -0,0 +1,38 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include "utils/BatchDCTKernel.hpp"
+
+#ifdef ADSI_ARCH_X86
+#    include <immintrin.h>
+
+namespace utils::batch_dct {
+namespace {
+/**
+ * @brief Vector operations of AVX2 kernel, 8 lanes fit into one 256 bit register.
+ */
+struct AVX2Ops
+{
+    using Vec = __m256;
+
+    static Vec load(const float *src) { return _mm256_loadu_ps(src); }
+    static void store(float *dst, Vec value) { _mm256_storeu_ps(dst, value); }
+    static Vec broadcast(float value) { return _mm256_set1_ps(value); }
+    static Vec zero() { return _mm256_setzero_ps(); }
+    static Vec fmadd(Vec lhs, Vec rhs, Vec addend) { return _mm256_fmadd_ps(lhs, rhs, addend); }
+};
+}
+
+void forwardAVX2(const float *basis, const float *input, float *output)
+{
+    forward<AVX2Ops>(basis, input, output);
+}
+
+void inverseAVX2(const float *basis, const float *input, float *output)
+{
+    inverse<AVX2Ops>(basis, input, output);
+}
+}
+#endif // ADSI_ARCH_X86
@@ -0,0 +1,111 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include "utils/BatchDCTKernel.hpp"
+
+#ifdef ADSI_ARCH_X86
+#    include <immintrin.h>
+
+namespace utils::batch_dct {
+namespace {
+/**
+ * @brief Repeat 8 lanes of @p value in both halves of a 512 bit register.
+ */
+inline __m512 duplicate(__m256 value)
+{
+    return _mm512_castpd_ps(_mm512_broadcast_f64x4(_mm256_castps_pd(value)));
+}
+
+/**
+ * @brief Build pairs of basis vectors, pair[p * 8 + k] hold basis(2p, k) and basis(2p + 1, k).
+ * @param basis Basis table.
+ * @param transpose Pair along sample index instead of frequency index when true.
+ * @param pairs Output pairs.
+ */
+inline void buildPairs(const float *basis, bool transpose, __m512 *pairs)
+{
+    for (std::size_t pair = 0; pair < blockSize / 2; pair++) {
+        for (std::size_t k = 0; k < blockSize; k++) {
+            const std::size_t first { transpose ? k * blockSize + pair * 2
+                                                : pair * 2 * blockSize + k };
+            const std::size_t second { first + (transpose ? 1 : blockSize) };
+            pairs[pair * blockSize + k] = _mm512_mask_blend_ps(
+                    0xff00, _mm512_set1_ps(basis[first]), _mm512_set1_ps(basis[second]));
+        }
+    }
+}
+}
+
+// Two neighbouring outputs of a pass are adjacent 8 lane groups in the interleaved layout, so every 512
+// bit register produce two outputs of the same 8 blocks at once.
+void forwardAVX512(const float *basis, const float *input, float *output)
+{
+    __m512 pairs[blockSize * blockSize / 2];
+    alignas(64) float rowPass[blockSize * blockSize * lanes];
+    buildPairs(basis, false, pairs);
+
+    for (std::size_t y = 0; y < blockSize; y++) {
+        __m512 samples[blockSize];
+        for (std::size_t x = 0; x < blockSize; x++) {
+            auto sample = _mm256_loadu_ps(input + (y * blockSize + x) * lanes);
+            samples[x] = duplicate(sample);
+        }
+
+        for (std::size_t pair = 0; pair < blockSize / 2; pair++) {
+            auto sum = _mm512_setzero_ps();
+            for (std::size_t x = 0; x < blockSize; x++)
+                sum = _mm512_fmadd_ps(pairs[pair * blockSize + x], samples[x], sum);
+            _mm512_store_ps(rowPass + (y * blockSize + pair * 2) * lanes, sum);
+        }
+    }
+
+    for (std::size_t v = 0; v < blockSize; v++) {
+        for (std::size_t pair = 0; pair < blockSize / 2; pair++) {
+            auto sum = _mm512_setzero_ps();
+            for (std::size_t y = 0; y < blockSize; y++) {
+                sum = _mm512_fmadd_ps(_mm512_set1_ps(basis[v * blockSize + y]),
+                                      _mm512_load_ps(rowPass + (y * blockSize + pair * 2) * lanes),
+                                      sum);
+            }
+            _mm512_storeu_ps(output + (v * blockSize + pair * 2) * lanes, sum);
+        }
+    }
+}
+
+void inverseAVX512(const float *basis, const float *input, float *output)
+{
+    __m512 pairs[blockSize * blockSize / 2];
+    alignas(64) float rowPass[blockSize * blockSize * lanes];
+    buildPairs(basis, true, pairs);
+
+    for (std::size_t v = 0; v < blockSize; v++) {
+        __m512 coefficients[blockSize];
+        for (std::size_t u = 0; u < blockSize; u++) {
+            auto coefficient = _mm256_loadu_ps(input + (v * blockSize + u) * lanes);
+            coefficients[u] = duplicate(coefficient);
+        }
+
+        for (std::size_t pair = 0; pair < blockSize / 2; pair++) {
+            auto sum = _mm512_setzero_ps();
+            for (std::size_t u = 0; u < blockSize; u++)
+                sum = _mm512_fmadd_ps(pairs[pair * blockSize + u], coefficients[u], sum);
+            _mm512_store_ps(rowPass + (v * blockSize + pair * 2) * lanes, sum);
+        }
+    }
+
+    for (std::size_t y = 0; y < blockSize; y++) {
+        for (std::size_t pair = 0; pair < blockSize / 2; pair++) {
+            auto sum = _mm512_setzero_ps();
+            for (std::size_t v = 0; v < blockSize; v++) {
+                sum = _mm512_fmadd_ps(_mm512_set1_ps(basis[v * blockSize + y]),
+                                      _mm512_load_ps(rowPass + (v * blockSize + pair * 2) * lanes),
+                                      sum);
+            }
+            _mm512_storeu_ps(output + (y * blockSize + pair * 2) * lanes, sum);
+        }
+    }
+}
+}
+#endif // ADSI_ARCH_X86
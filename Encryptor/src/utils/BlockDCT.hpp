@@ -0,0 +1,73 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace utils {
+/**
+ * @brief Fixed size NxN DCT engine.
+ *
+ * Transform flat row major NxN blocks with orthonormal 2D DCT-II and its inverse. The transform is done
+ * as a row pass followed by a column pass, both multiply against a basis table which built at compile
+ * time, so no trigonometry or heap allocation happened per block. Every loop bound is a compile time
+ * constant, so each size get its own unrolled kernel. Only 4, 8, 16 and 32 are instantiated.
+ *
+ * @tparam N Width and height of a block.
+ */
+template<std::size_t N>
+class BasicBlockDCT
+{
+    static_assert(N == 4 || N == 8 || N == 16 || N == 32, "Unsupported DCT block size.");
+
+public:
+    /**
+     * @brief Width and height of a block.
+     */
+    static constexpr std::size_t blockSize { N };
+    /**
+     * @brief Amount of samples in a block.
+     */
+    static constexpr std::size_t blockArea { blockSize * blockSize };
+    /**
+     * @brief Row major block of samples or coefficients.
+     */
+    using Block = std::array<float, blockArea>;
+
+    /**
+     * @brief Orthonormal DCT-II basis used by the transform.
+     * @return Basis table, basis[u * N + x] = a(u) * cos((2x + 1) * u * pi / 2N).
+     */
+    static const Block &basis();
+
+    /**
+     * @brief Transform block of samples into DCT coefficients.
+     * @param input Samples of the block.
+     * @param output Coefficients of the block, coefficient of frequency (u, v) locate at [v * N + u].
+     *
+     * @note @p input and @p output may refer to the same block.
+     */
+    void transform(const Block &input, Block &output) const;
+    /**
+     * @brief Transform block of DCT coefficients back into samples.
+     * @param input Coefficients of the block.
+     * @param output Samples of the block.
+     *
+     * @note @p input and @p output may refer to the same block.
+     */
+    void itransform(const Block &input, Block &output) const;
+};
+
+extern template class BasicBlockDCT<4>;
+extern template class BasicBlockDCT<8>;
+extern template class BasicBlockDCT<16>;
+extern template class BasicBlockDCT<32>;
+
+/**
+ * @brief 8x8 DCT engine, the block size used by JPEG and the watermark.
+ */
+using BlockDCT = BasicBlockDCT<8>;
+}
@@ -0,0 +1,112 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <array>
+#include <cstdint>
+
+#include "utils/CPUFeatures.hpp"
+
+#ifdef ADSI_ARCH_X86
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#    else
+#        include <cpuid.h>
+#    endif
+#endif
+
+namespace utils {
+namespace {
+#ifdef ADSI_ARCH_X86
+/**
+ * @brief Execute CPUID.
+ * @param leaf Leaf to query, EAX.
+ * @param subLeaf Sub leaf to query, ECX.
+ * @return Register EAX, EBX, ECX and EDX in order.
+ */
+std::array<std::uint32_t, 4> cpuid(std::uint32_t leaf, std::uint32_t subLeaf)
+{
+    std::array<std::uint32_t, 4> registers {};
+#    ifdef _MSC_VER
+    std::array<int, 4> info {};
+    __cpuidex(info.data(), static_cast<int>(leaf), static_cast<int>(subLeaf));
+    for (std::size_t idx = 0; idx < info.size(); idx++)
+        registers[idx] = static_cast<std::uint32_t>(info[idx]);
+#    else
+    __cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#    endif
+    return registers;
+}
+
+/**
+ * @brief Read extended control register 0, which tell the register states saved by the OS.
+ * @return Value of XCR0.
+ */
+std::uint64_t readXCR0()
+{
+#    ifdef _MSC_VER
+    return _xgetbv(0);
+#    else
+    std::uint32_t low { 0 };
+    std::uint32_t high { 0 };
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<std::uint64_t>(high) << 32) | low;
+#    endif
+}
+#endif // ADSI_ARCH_X86
+}
+
+const CPUFeatures &CPUFeatures::getInstance()
+{
+    static const CPUFeatures instance;
+    return instance;
+}
+
+bool CPUFeatures::hasSSE2() const
+{
+    return sse2_;
+}
+
+bool CPUFeatures::hasPOPCNT() const
+{
+    return popcnt_;
+}
+
+bool CPUFeatures::hasAVX2() const
+{
+    return avx2_;
+}
+
+bool CPUFeatures::hasAVX512() const
+{
+    return avx512_;
+}
+
+CPUFeatures::CPUFeatures()
+{
+#ifdef ADSI_ARCH_X86
+    constexpr std::uint32_t xmmYmmState { 0x6 };
+    constexpr std::uint32_t zmmState { 0xe6 };
+
+    const auto maxLeaf = cpuid(0, 0)[0];
+    if (maxLeaf < 1) return;
+
+    const auto leaf1 = cpuid(1, 0);
+    sse2_ = (leaf1[3] & (1u << 26)) != 0;
+    popcnt_ = (leaf1[2] & (1u << 23)) != 0;
+
+    const bool fma { (leaf1[2] & (1u << 12)) != 0 };
+    const bool osxsave { (leaf1[2] & (1u << 27)) != 0 };
+    const bool avx { (leaf1[2] & (1u << 28)) != 0 };
+    if (!osxsave || !avx || maxLeaf < 7) return;
+
+    const auto xcr0 = readXCR0();
+    if ((xcr0 & xmmYmmState) != xmmYmmState) return;
+
+    const auto leaf7 = cpuid(7, 0);
+    avx2_ = fma && (leaf7[1] & (1u << 5)) != 0;
+    avx512_ = (leaf7[1] & (1u << 16)) != 0 && (xcr0 & zmmState) == zmmState;
+#endif // ADSI_ARCH_X86
+}
+}
@@ -0,0 +1,127 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <memory>
+
+#include "utils/BlockDCT.hpp"
+
+namespace utils {
+/**
+ * @brief Contiguous storage of every 8x8 block of an image channel.
+ *
+ * Blocks are stored in block row major order, block (col, row) is followed by block (col + 1, row). The
+ * storage is a single cache line aligned allocation, so a whole plane can be streamed or handed to
+ * vectorized kernels without gathering.
+ */
+class CoefficientPlane
+{
+public:
+    /**
+     * @brief Alignment of the storage in bytes.
+     */
+    static constexpr std::size_t alignment { 64 };
+
+    /**
+     * @brief Create empty plane.
+     */
+    CoefficientPlane() = default;
+    /**
+     * @brief Create plane large enough to hold a channel of @p width x @p height samples.
+     * @param width Width of the channel in samples.
+     * @param height Height of the channel in samples.
+     */
+    CoefficientPlane(int width, int height);
+
+    /**
+     * @brief Reallocate the plane to hold channel of @p width x @p height samples.
+     *
+     * Nothing is reallocated if the plane already has the same amount of blocks. Content of the blocks is
+     * unspecified after resized.
+     *
+     * @param width Width of the channel in samples.
+     * @param height Height of the channel in samples.
+     */
+    void resize(int width, int height);
+
+public: // Accessors
+    /**
+     * @brief Width of the channel this plane represent.
+     */
+    int width() const;
+    /**
+     * @brief Height of the channel this plane represent.
+     */
+    int height() const;
+    /**
+     * @brief Amount of blocks in a block row.
+     */
+    int blockColumns() const;
+    /**
+     * @brief Amount of block rows.
+     */
+    int blockRows() const;
+    /**
+     * @brief Amount of blocks in the plane.
+     */
+    std::size_t blockCount() const;
+    /**
+     * @brief Get block at block coordinate.
+     * @param col Column of the block.
+     * @param row Row of the block.
+     * @return Reference to the block.
+     */
+    BlockDCT::Block &block(int col, int row);
+    /**
+     * @copydoc block(int, int)
+     */
+    const BlockDCT::Block &block(int col, int row) const;
+    /**
+     * @brief Get first block of the plane, the rest of the blocks follow contiguously.
+     * @return Pointer to the first block, nullptr if the plane is empty.
+     */
+    BlockDCT::Block *data();
+    /**
+     * @copydoc data()
+     */
+    const BlockDCT::Block *data() const;
+
+private:
+    /**
+     * @brief Deleter which release storage allocated with alignment.
+     */
+    struct AlignedDelete
+    {
+        void operator()(BlockDCT::Block *blocks) const;
+    };
+
+private:
+    /**
+     * @brief Width of the channel in samples.
+     */
+    int width_ { 0 };
+    /**
+     * @brief Height of the channel in samples.
+     */
+    int height_ { 0 };
+    /**
+     * @brief Amount of blocks in a block row.
+     */
+    int blockColumns_ { 0 };
+    /**
+     * @brief Amount of block rows.
+     */
+    int blockRows_ { 0 };
+    /**
+     * @brief Amount of blocks allocated.
+     */
+    std::size_t capacity_ { 0 };
+    /**
+     * @brief Aligned storage of blocks.
+     */
+    std::unique_ptr<BlockDCT::Block[], AlignedDelete> blocks_;
+};
+}
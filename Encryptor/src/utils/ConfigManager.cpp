@@ -3,6 +3,7 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
+#include <algorithm>
 #include <fstream>
 #include <QFileInfo>
 #include <utils/ConfigManager.hpp>
@@ -25,6 +26,16 @@ void ConfigManager::loadConfig()
     document = YAML::LoadFile(cfgFileInfo.absoluteFilePath().toStdString());
     setEnableHighDPIScaling(document["app"][ConfigName::enableHighDPIScaling.data()].as<bool>(
             isEnableHighDPIScaling()));
+    setWorkerThreads(
+            document["app"][ConfigName::workerThreads.data()].as<int>(getWorkerThreads()));
+    setKeyFingerprintSize(document["app"][ConfigName::keyFingerprintSize.data()].as<int>(
+            getKeyFingerprintSize()));
+    setTrustedKeysPath(document["app"][ConfigName::trustedKeysPath.data()].as<std::string>(
+            getTrustedKeysPath()));
+    setSimilarityIndexPath(document["app"][ConfigName::similarityIndexPath.data()].as<std::string>(
+            getSimilarityIndexPath()));
+    setHashCachePath(document["app"][ConfigName::hashCachePath.data()].as<std::string>(
+            getHashCachePath()));
 }
 
 void ConfigManager::dumpConfig()
@@ -32,6 +43,11 @@ void ConfigManager::dumpConfig()
     YAML::Node document;
 
     document["app"][ConfigName::enableHighDPIScaling.data()] = isEnableHighDPIScaling();
+    document["app"][ConfigName::workerThreads.data()] = getWorkerThreads();
+    document["app"][ConfigName::keyFingerprintSize.data()] = getKeyFingerprintSize();
+    document["app"][ConfigName::trustedKeysPath.data()] = getTrustedKeysPath();
+    document["app"][ConfigName::similarityIndexPath.data()] = getSimilarityIndexPath();
+    document["app"][ConfigName::hashCachePath.data()] = getHashCachePath();
 
     std::ofstream cfgWriter { ConfigName::cfgFileName.data() };
     if (!cfgWriter.is_open())
@@ -45,10 +61,60 @@ bool ConfigManager::isEnableHighDPIScaling() const
     return _enableHighDPIScaling;
 }
 
+int ConfigManager::getWorkerThreads() const
+{
+    return _workerThreads;
+}
+
+int ConfigManager::getKeyFingerprintSize() const
+{
+    return _keyFingerprintSize;
+}
+
+const std::string &ConfigManager::getTrustedKeysPath() const
+{
+    return _trustedKeysPath;
+}
+
+const std::string &ConfigManager::getSimilarityIndexPath() const
+{
+    return _similarityIndexPath;
+}
+
+const std::string &ConfigManager::getHashCachePath() const
+{
+    return _hashCachePath;
+}
+
 void ConfigManager::setEnableHighDPIScaling(bool value)
 {
     _enableHighDPIScaling = value;
 }
 
+void ConfigManager::setWorkerThreads(int value)
+{
+    _workerThreads = std::max(value, 0);
+}
+
+void ConfigManager::setKeyFingerprintSize(int value)
+{
+    _keyFingerprintSize = value == 16 || value == 32 ? value : 0;
+}
+
+void ConfigManager::setTrustedKeysPath(std::string value)
+{
+    _trustedKeysPath = std::move(value);
+}
+
+void ConfigManager::setSimilarityIndexPath(std::string value)
+{
+    _similarityIndexPath = std::move(value);
+}
+
+void ConfigManager::setHashCachePath(std::string value)
+{
+    _hashCachePath = std::move(value);
+}
+
 ConfigManager::ConfigManager() { }
 }
\ No newline at end of file
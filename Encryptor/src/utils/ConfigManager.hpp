@@ -4,6 +4,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
 #pragma once
+#include <string>
 #include <string_view>
 
 namespace utils {
@@ -27,6 +28,26 @@ class ConfigManager
          * @brief Name of enable high DPI scaling in config file.
          */
         static constexpr std::string_view enableHighDPIScaling { "enable high dpi scaling" };
+        /**
+         * @brief Name of worker threads in config file.
+         */
+        static constexpr std::string_view workerThreads { "worker threads" };
+        /**
+         * @brief Name of key fingerprint size in config file.
+         */
+        static constexpr std::string_view keyFingerprintSize { "key fingerprint size" };
+        /**
+         * @brief Name of trusted keys directory in config file.
+         */
+        static constexpr std::string_view trustedKeysPath { "trusted keys path" };
+        /**
+         * @brief Name of similarity index file in config file.
+         */
+        static constexpr std::string_view similarityIndexPath { "similarity index path" };
+        /**
+         * @brief Name of hash cache file in config file.
+         */
+        static constexpr std::string_view hashCachePath { "hash cache path" };
     };
 
 public:
@@ -60,6 +81,42 @@ public: // Accessors
      * @sa setEnableHighDPIScaling(bool)
      */
     bool isEnableHighDPIScaling() const;
+    /**
+     * @brief Get amount of threads used by image processing.
+     * @return Amount of threads including the thread which waits for the processing, 0 to use one thread
+     * per hardware thread.
+     *
+     * @sa setWorkerThreads(int)
+     */
+    int getWorkerThreads() const;
+    /**
+     * @brief Get size of the key fingerprint embedded into signed images.
+     * @return Size in bytes, 0 to embed the public key.
+     *
+     * @sa setKeyFingerprintSize(int)
+     */
+    int getKeyFingerprintSize() const;
+    /**
+     * @brief Get directory of the public keys trusted to resolve key fingerprints.
+     * @return Path to the directory.
+     *
+     * @sa setTrustedKeysPath(std::string)
+     */
+    const std::string &getTrustedKeysPath() const;
+    /**
+     * @brief Get file of the index of the perceptual hashes of signed images.
+     * @return Path to the file.
+     *
+     * @sa setSimilarityIndexPath(std::string)
+     */
+    const std::string &getSimilarityIndexPath() const;
+    /**
+     * @brief Get file of the cache of the hashes of image files.
+     * @return Path to the file.
+     *
+     * @sa setHashCachePath(std::string)
+     */
+    const std::string &getHashCachePath() const;
 
 public: // Mutators
     /**
@@ -69,6 +126,42 @@ public: // Mutators
      * @sa isEnableHighDPIScaling()
      */
     void setEnableHighDPIScaling(bool value);
+    /**
+     * @brief Modify amount of threads used by image processing.
+     * @param value Amount of threads including the thread which waits for the processing, so 1 starts no
+     * worker, 0 to use one thread per hardware thread, negative values are treated as 0.
+     *
+     * @sa getWorkerThreads()
+     */
+    void setWorkerThreads(int value);
+    /**
+     * @brief Modify size of the key fingerprint embedded into signed images.
+     * @param value Size in bytes, 16 or 32, any other value embeds the public key.
+     *
+     * @sa getKeyFingerprintSize()
+     */
+    void setKeyFingerprintSize(int value);
+    /**
+     * @brief Modify directory of the public keys trusted to resolve key fingerprints.
+     * @param value Path to the directory.
+     *
+     * @sa getTrustedKeysPath()
+     */
+    void setTrustedKeysPath(std::string value);
+    /**
+     * @brief Modify file of the index of the perceptual hashes of signed images.
+     * @param value Path to the file.
+     *
+     * @sa getSimilarityIndexPath()
+     */
+    void setSimilarityIndexPath(std::string value);
+    /**
+     * @brief Modify file of the cache of the hashes of image files.
+     * @param value Path to the file.
+     *
+     * @sa getHashCachePath()
+     */
+    void setHashCachePath(std::string value);
 
 private:
     /**
@@ -86,6 +179,41 @@ private:
      * @sa setEnableHighDPIScaling(bool)
      */
     bool _enableHighDPIScaling { true };
+    /**
+     * @brief Amount of worker threads used by image processing, 0 for one per hardware thread.
+     *
+     * @sa getWorkerThreads()
+     * @sa setWorkerThreads(int)
+     */
+    int _workerThreads { 0 };
+    /**
+     * @brief Size of the key fingerprint embedded into signed images, 0 to embed the public key.
+     *
+     * @sa getKeyFingerprintSize()
+     * @sa setKeyFingerprintSize(int)
+     */
+    int _keyFingerprintSize { 0 };
+    /**
+     * @brief Directory of the public keys trusted to resolve key fingerprints.
+     *
+     * @sa getTrustedKeysPath()
+     * @sa setTrustedKeysPath(std::string)
+     */
+    std::string _trustedKeysPath { "trusted-keys" };
+    /**
+     * @brief File of the index of the perceptual hashes of signed images, next to the database.
+     *
+     * @sa getSimilarityIndexPath()
+     * @sa setSimilarityIndexPath(std::string)
+     */
+    std::string _similarityIndexPath { "signed-hashes.idx" };
+    /**
+     * @brief File of the cache of the hashes of image files.
+     *
+     * @sa getHashCachePath()
+     * @sa setHashCachePath(std::string)
+     */
+    std::string _hashCachePath { "hash-cache.dat" };
     /** @} */
 };
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+
+namespace utils::const_math {
+/**
+ * @brief Value of pi in double precision.
+ */
+constexpr double pi { 3.141592653589793238462643383279502884 };
+
+/**
+ * @brief Compile time evaluable cosine.
+ *
+ * std::cos is not constexpr, this function reduce @p x into [-pi, pi] and evaluate the Taylor series
+ * until the terms vanish, which is accurate to double precision for the range reduced input.
+ *
+ * @param x Angle in radian.
+ * @return Cosine of @p x.
+ */
+constexpr double cos(double x)
+{
+    constexpr double twoPi { 2.0 * pi };
+    while (x > pi) x -= twoPi;
+    while (x < -pi) x += twoPi;
+
+    double sum { 1.0 };
+    double term { 1.0 };
+    for (int n = 1; n < 32; n++) {
+        term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief Compile time evaluable square root with Newton-Raphson method.
+ * @param x Value to evaluate, must not be negative.
+ * @return Square root of @p x.
+ */
+constexpr double sqrt(double x)
+{
+    if (x <= 0.0) return 0.0;
+
+    double current { x > 1.0 ? x : 1.0 };
+    for (int iteration = 0; iteration < 128; iteration++) {
+        double next { 0.5 * (current + x / current) };
+        if (next == current) break;
+        current = next;
+    }
+    return current;
+}
+}
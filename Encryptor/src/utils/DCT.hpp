@@ -4,60 +4,141 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
 #pragma once
+#include <QImage>
+
 #include <vector>
 
+#include "utils/BatchDCT.hpp"
+#include "utils/BlockDCT.hpp"
+#include "utils/CoefficientPlane.hpp"
+#include "utils/FastDCT.hpp"
+
 namespace utils {
 /**
  * @brief Utility class that provide DCT transform algorithm.
  *
- * This utility transfrom std::vector into DCT wave or DCT wave to raw data.
+ * This utility transfrom std::vector into DCT wave or DCT wave to raw data. Samples are level shifted by
+ * 128 before transform and after inverse transform. The algorithm is selected by DCT::Mode, the work is
+ * forwarded to utils::BlockDCT by default, prefer it directly when the data is already in flat blocks.
  */
 class DCT
 {
 public:
+    /**
+     * @brief Channel of an image to transform.
+     */
+    enum class Channel {
+        Red, /**< Red channel. */
+        Green, /**< Green channel. */
+        Blue, /**< Blue channel. */
+        Alpha /**< Alpha channel. */
+    };
+    /**
+     * @brief Algorithm used by the transform.
+     */
+    enum class Mode {
+        Reference, /**< Direct evaluation of the DCT formula, slow but straightforward. */
+        Separable, /**< Separable transform with basis table, see utils::BlockDCT and utils::BatchDCT. */
+        FastFloat, /**< AAN factorization in float, see utils::FastDCT. */
+        FastInteger /**< LL&M factorization in fixed point, samples and coefficients are rounded. */
+    };
+
+public:
+    /**
+     * @brief Create transform with Mode::Separable.
+     */
+    DCT() = default;
+    /**
+     * @brief Create transform with specific algorithm.
+     * @param mode Algorithm to use.
+     */
+    explicit DCT(Mode mode);
+
     /**
      * Transfrom std::vector into 2D DCT wave.
      * @param input Input data.
      * @return 2D DCT wave.
+     * @throw std::invalid_argument if @p input is not 8x8.
      */
     std::vector<std::vector<float>> transfrom(const std::vector<std::vector<float>> &input);
     /**
      * Transfrom std::vector of 2D DCT wave to raw data.
      * @param input DCT wave.
      * @return Inverse transform of 2D DCT.
+     * @throw std::invalid_argument if @p input is not 8x8.
      */
     std::vector<std::vector<float>> itransform(const std::vector<std::vector<float>> &input);
+    /**
+     * Transform a channel of the whole image into 2D DCT waves of every 8x8 block.
+     *
+     * The image is read with scanlines in its QImage::Format_ARGB32 form, images in other formats are
+     * converted first. Blocks on the right and bottom edge are padded by repeating the last column and row.
+     * Block rows are split into tiles which are transformed in parallel on utils::ThreadPool.
+     *
+     * @param image Image to transform.
+     * @param channel Channel of @p image to transform.
+     * @param plane Coefficient plane to write, resized to fit @p image.
+     */
+    void transformPlane(const QImage &image, Channel channel, CoefficientPlane &plane);
+    /**
+     * Inverse transform a coefficient plane back into a channel of an image.
+     *
+     * Other channels of @p image are left untouched, samples are rounded and clamped into [0, 255]. Block
+     * rows are split into tiles which are transformed in parallel on utils::ThreadPool.
+     *
+     * @param plane Coefficient plane to inverse transform.
+     * @param channel Channel of @p image to write.
+     * @param image Image to write, converted into QImage::Format_ARGB32 if it is in other format.
+     * @throw std::invalid_argument if size of @p image does not match @p plane.
+     */
+    void itransformPlane(const CoefficientPlane &plane, Channel channel, QImage &image);
+
+public: // Accessors
+    /**
+     * @brief Get algorithm used by the transform.
+     */
+    Mode mode() const;
 
 private:
     /**
-     * Helper function of converting raw data into DCT wave.
-     * @param input Data input.
-     * @param rslt DCT wave output
+     * Transform contiguous level shifted blocks in place with the selected algorithm.
+     * @param blocks First block to transform.
+     * @param count Amount of blocks.
+     */
+    void transformBlocks(BlockDCT::Block *blocks, std::size_t count) const;
+    /**
+     * Inverse transform contiguous blocks in place with the selected algorithm.
+     * @param blocks First block to transform.
+     * @param count Amount of blocks.
+     */
+    void itransformBlocks(BlockDCT::Block *blocks, std::size_t count) const;
+    /**
+     * Helper function of flattening 8x8 nested vector into block.
+     * @param input Data input, must be 8x8.
+     * @return Row major block of @p input.
+     * @throw std::invalid_argument if @p input is not 8x8.
      */
-    void transfromVector(const std::vector<std::vector<float>> &input,
-                         std::vector<std::vector<float>> &rslt);
+    BlockDCT::Block toBlock(const std::vector<std::vector<float>> &input);
+    /**
+     * Helper function of expanding block into 8x8 nested vector.
+     * @param block Row major block.
+     * @return Nested vector of @p block.
+     */
+    std::vector<std::vector<float>> fromBlock(const BlockDCT::Block &block);
+
+private:
     /**
-     * Helper function of converting DCT wave into raw data.
-     * @param input DCT data input.
-     * @param rslt Raw data output.
+     * @brief Algorithm used by the transform.
      */
-    void itransfromVector(const std::vector<std::vector<float>> &input,
-                          std::vector<std::vector<float>> &rslt);
+    Mode mode_ { Mode::Separable };
     /**
-     * Helper function of adding data of raw data with provided u and v variable.
-     * @param input Data input
-     * @param u u variable in DCT
-     * @param v v variable in DCT
-     * @return DCT value of data at [v][u].
+     * @brief Vectorized engine of Mode::Separable, block counts that could not fill a batch fall back to
+     * utils::BlockDCT.
      */
-    float dctAdder(const std::vector<std::vector<float>> &input, int u, int v);
+    BatchDCT batch_;
     /**
-     * Helper function of adding data of DCT data with provided x and y variable.
-     * @param input DCT data input.
-     * @param x x varaible in DCT.
-     * @param y y varaible in DCT.
-     * @return Inverse DCT value of data at [y][x].
+     * @brief Factorized DCT engine of Mode::FastFloat and Mode::FastInteger.
      */
-    float idctAdder(const std::vector<std::vector<float>> &input, int x, int y);
+    FastDCT fast_;
 };
 }
\ No newline at end of file
@@ -0,0 +1,335 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <algorithm>
+#include <functional>
+
+#include "utils/ConstMath.hpp"
+#include "utils/FastDCT.hpp"
+
+namespace utils {
+namespace {
+constexpr std::size_t blockSize { BlockDCT::blockSize };
+
+/**
+ * @brief Fraction bits of the fixed point constants.
+ */
+constexpr int constBits { 13 };
+/**
+ * @brief Extra fraction bits kept between the two passes of the integer transform.
+ */
+constexpr int pass1Bits { 2 };
+
+/**
+ * @brief Convert constant into 13 bit fixed point.
+ * @param value Constant to convert.
+ * @return Rounded fixed point value of @p value.
+ */
+constexpr std::int32_t fix(double value)
+{
+    return static_cast<std::int32_t>(value * (1 << constBits) + 0.5);
+}
+
+/**
+ * @brief Divide by 2 ^ @p bits with rounding.
+ * @param value Value to divide.
+ * @param bits Amount of bits to shift.
+ * @return Rounded quotient.
+ */
+constexpr std::int32_t descale(std::int32_t value, int bits)
+{
+    return (value + (std::int32_t { 1 } << (bits - 1))) >> bits;
+}
+
+/**
+ * @brief Per coefficient scale of AAN, scale[0] = 1 and scale[k] = sqrt(2) * cos(k * pi / 16).
+ * @param k Frequency.
+ * @return Scale of the frequency.
+ */
+constexpr double aanScale(std::size_t k)
+{
+    return k == 0 ? 1.0 : const_math::sqrt(2.0) * const_math::cos(k * const_math::pi / 16.0);
+}
+
+/**
+ * @brief Build table which turn forward AAN output into orthonormal coefficients.
+ * @return Table of 1 / (8 * scale[u] * scale[v]).
+ */
+constexpr BlockDCT::Block makeForwardScale()
+{
+    BlockDCT::Block table {};
+    for (std::size_t v = 0; v < blockSize; v++) {
+        for (std::size_t u = 0; u < blockSize; u++)
+            table[v * blockSize + u] = static_cast<float>(1.0 / (8.0 * aanScale(u) * aanScale(v)));
+    }
+    return table;
+}
+
+/**
+ * @brief Build table which turn orthonormal coefficients into inverse AAN input.
+ * @return Table of scale[u] * scale[v] / 8.
+ */
+constexpr BlockDCT::Block makeInverseScale()
+{
+    BlockDCT::Block table {};
+    for (std::size_t v = 0; v < blockSize; v++) {
+        for (std::size_t u = 0; u < blockSize; u++)
+            table[v * blockSize + u] = static_cast<float>(aanScale(u) * aanScale(v) / 8.0);
+    }
+    return table;
+}
+
+constexpr BlockDCT::Block forwardScale { makeForwardScale() };
+constexpr BlockDCT::Block inverseScale { makeInverseScale() };
+
+/**
+ * @brief Unscaled 1D forward AAN transform of 8 samples in place.
+ * @param data First sample.
+ * @param stride Distance between samples.
+ */
+void forwardFloat(float *data, std::size_t stride)
+{
+    auto at = [&](std::size_t idx) -> float & { return data[idx * stride]; };
+
+    const float tmp0 { at(0) + at(7) };
+    const float tmp7 { at(0) - at(7) };
+    const float tmp1 { at(1) + at(6) };
+    const float tmp6 { at(1) - at(6) };
+    const float tmp2 { at(2) + at(5) };
+    const float tmp5 { at(2) - at(5) };
+    const float tmp3 { at(3) + at(4) };
+    const float tmp4 { at(3) - at(4) };
+
+    // Even part
+    float tmp10 { tmp0 + tmp3 };
+    const float tmp13 { tmp0 - tmp3 };
+    float tmp11 { tmp1 + tmp2 };
+    float tmp12 { tmp1 - tmp2 };
+
+    at(0) = tmp10 + tmp11;
+    at(4) = tmp10 - tmp11;
+
+    const float z1 { (tmp12 + tmp13) * 0.707106781f };
+    at(2) = tmp13 + z1;
+    at(6) = tmp13 - z1;
+
+    // Odd part
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    const float z5 { (tmp10 - tmp12) * 0.382683433f };
+    const float z2 { 0.541196100f * tmp10 + z5 };
+    const float z4 { 1.306562965f * tmp12 + z5 };
+    const float z3 { tmp11 * 0.707106781f };
+
+    const float z11 { tmp7 + z3 };
+    const float z13 { tmp7 - z3 };
+
+    at(5) = z13 + z2;
+    at(3) = z13 - z2;
+    at(1) = z11 + z4;
+    at(7) = z11 - z4;
+}
+
+/**
+ * @brief Unscaled 1D inverse AAN transform of 8 coefficients in place.
+ * @param data First coefficient.
+ * @param stride Distance between coefficients.
+ */
+void inverseFloat(float *data, std::size_t stride)
+{
+    auto at = [&](std::size_t idx) -> float & { return data[idx * stride]; };
+
+    // Even part
+    const float tmp10 { at(0) + at(4) };
+    const float tmp11 { at(0) - at(4) };
+    const float tmp13 { at(2) + at(6) };
+    const float tmp12 { (at(2) - at(6)) * 1.414213562f - tmp13 };
+
+    const float tmp0 { tmp10 + tmp13 };
+    const float tmp3 { tmp10 - tmp13 };
+    const float tmp1 { tmp11 + tmp12 };
+    const float tmp2 { tmp11 - tmp12 };
+
+    // Odd part
+    const float z13 { at(5) + at(3) };
+    const float z10 { at(5) - at(3) };
+    const float z11 { at(1) + at(7) };
+    const float z12 { at(1) - at(7) };
+
+    const float tmp7 { z11 + z13 };
+    const float tmp11Odd { (z11 - z13) * 1.414213562f };
+    const float z5 { (z10 + z12) * 1.847759065f };
+    const float tmp10Odd { 1.082392200f * z12 - z5 };
+    const float tmp12Odd { -2.613125930f * z10 + z5 };
+
+    const float tmp6 { tmp12Odd - tmp7 };
+    const float tmp5 { tmp11Odd - tmp6 };
+    const float tmp4 { tmp10Odd + tmp5 };
+
+    at(0) = tmp0 + tmp7;
+    at(7) = tmp0 - tmp7;
+    at(1) = tmp1 + tmp6;
+    at(6) = tmp1 - tmp6;
+    at(2) = tmp2 + tmp5;
+    at(5) = tmp2 - tmp5;
+    at(4) = tmp3 + tmp4;
+    at(3) = tmp3 - tmp4;
+}
+
+/**
+ * @brief 1D forward LL&M transform of 8 samples in place.
+ *
+ * Every output is scaled by 2 ^ 13 before descaling, so even and odd outputs share the same shift.
+ *
+ * @param data First sample.
+ * @param stride Distance between samples.
+ * @param shift Bits to descale the outputs.
+ */
+void forwardInteger(std::int32_t *data, std::size_t stride, int shift)
+{
+    auto at = [&](std::size_t idx) -> std::int32_t & { return data[idx * stride]; };
+
+    std::int32_t tmp0 { at(0) + at(7) };
+    std::int32_t tmp7 { at(0) - at(7) };
+    std::int32_t tmp1 { at(1) + at(6) };
+    std::int32_t tmp6 { at(1) - at(6) };
+    std::int32_t tmp2 { at(2) + at(5) };
+    std::int32_t tmp5 { at(2) - at(5) };
+    std::int32_t tmp3 { at(3) + at(4) };
+    std::int32_t tmp4 { at(3) - at(4) };
+
+    // Even part
+    const std::int32_t tmp10 { tmp0 + tmp3 };
+    const std::int32_t tmp13 { tmp0 - tmp3 };
+    const std::int32_t tmp11 { tmp1 + tmp2 };
+    const std::int32_t tmp12 { tmp1 - tmp2 };
+
+    at(0) = descale((tmp10 + tmp11) * (1 << constBits), shift);
+    at(4) = descale((tmp10 - tmp11) * (1 << constBits), shift);
+
+    const std::int32_t z1 { (tmp12 + tmp13) * fix(0.541196100) };
+    at(2) = descale(z1 + tmp13 * fix(0.765366865), shift);
+    at(6) = descale(z1 - tmp12 * fix(1.847759065), shift);
+
+    // Odd part
+    std::int32_t z1Odd { tmp4 + tmp7 };
+    std::int32_t z2 { tmp5 + tmp6 };
+    std::int32_t z3 { tmp4 + tmp6 };
+    std::int32_t z4 { tmp5 + tmp7 };
+    const std::int32_t z5 { (z3 + z4) * fix(1.175875602) };
+
+    tmp4 *= fix(0.298631336);
+    tmp5 *= fix(2.053119869);
+    tmp6 *= fix(3.072711026);
+    tmp7 *= fix(1.501321110);
+    z1Odd *= -fix(0.899976223);
+    z2 *= -fix(2.562915447);
+    z3 = z3 * -fix(1.961570560) + z5;
+    z4 = z4 * -fix(0.390180644) + z5;
+
+    at(7) = descale(tmp4 + z1Odd + z3, shift);
+    at(5) = descale(tmp5 + z2 + z4, shift);
+    at(3) = descale(tmp6 + z2 + z3, shift);
+    at(1) = descale(tmp7 + z1Odd + z4, shift);
+}
+
+/**
+ * @brief 1D inverse LL&M transform of 8 coefficients in place.
+ * @param data First coefficient.
+ * @param stride Distance between coefficients.
+ * @param shift Bits to descale the outputs.
+ */
+void inverseInteger(std::int32_t *data, std::size_t stride, int shift)
+{
+    auto at = [&](std::size_t idx) -> std::int32_t & { return data[idx * stride]; };
+
+    // Even part
+    const std::int32_t z1 { (at(2) + at(6)) * fix(0.541196100) };
+    std::int32_t tmp2 { z1 - at(6) * fix(1.847759065) };
+    std::int32_t tmp3 { z1 + at(2) * fix(0.765366865) };
+
+    std::int32_t tmp0 { (at(0) + at(4)) * (1 << constBits) };
+    std::int32_t tmp1 { (at(0) - at(4)) * (1 << constBits) };
+
+    const std::int32_t tmp10 { tmp0 + tmp3 };
+    const std::int32_t tmp13 { tmp0 - tmp3 };
+    const std::int32_t tmp11 { tmp1 + tmp2 };
+    const std::int32_t tmp12 { tmp1 - tmp2 };
+
+    // Odd part
+    tmp0 = at(7);
+    tmp1 = at(5);
+    tmp2 = at(3);
+    tmp3 = at(1);
+
+    std::int32_t z1Odd { tmp0 + tmp3 };
+    std::int32_t z2 { tmp1 + tmp2 };
+    std::int32_t z3 { tmp0 + tmp2 };
+    std::int32_t z4 { tmp1 + tmp3 };
+    const std::int32_t z5 { (z3 + z4) * fix(1.175875602) };
+
+    tmp0 *= fix(0.298631336);
+    tmp1 *= fix(2.053119869);
+    tmp2 *= fix(3.072711026);
+    tmp3 *= fix(1.501321110);
+    z1Odd *= -fix(0.899976223);
+    z2 *= -fix(2.562915447);
+    z3 = z3 * -fix(1.961570560) + z5;
+    z4 = z4 * -fix(0.390180644) + z5;
+
+    tmp0 += z1Odd + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1Odd + z4;
+
+    at(0) = descale(tmp10 + tmp3, shift);
+    at(7) = descale(tmp10 - tmp3, shift);
+    at(1) = descale(tmp11 + tmp2, shift);
+    at(6) = descale(tmp11 - tmp2, shift);
+    at(2) = descale(tmp12 + tmp1, shift);
+    at(5) = descale(tmp12 - tmp1, shift);
+    at(3) = descale(tmp13 + tmp0, shift);
+    at(4) = descale(tmp13 - tmp0, shift);
+}
+}
+
+void FastDCT::transform(const BlockDCT::Block &input, BlockDCT::Block &output) const
+{
+    output = input;
+    for (std::size_t y = 0; y < blockSize; y++) forwardFloat(&output[y * blockSize], 1);
+    for (std::size_t u = 0; u < blockSize; u++) forwardFloat(&output[u], blockSize);
+    for (std::size_t idx = 0; idx < output.size(); idx++) output[idx] *= forwardScale[idx];
+}
+
+void FastDCT::itransform(const BlockDCT::Block &input, BlockDCT::Block &output) const
+{
+    std::transform(input.begin(), input.end(), inverseScale.begin(), output.begin(),
+                   std::multiplies<float> {});
+    for (std::size_t u = 0; u < blockSize; u++) inverseFloat(&output[u], blockSize);
+    for (std::size_t y = 0; y < blockSize; y++) inverseFloat(&output[y * blockSize], 1);
+}
+
+void FastDCT::transform(const IntegerBlock &input, IntegerBlock &output) const
+{
+    // The row pass keeps pass1Bits extra bits, the column pass drop them together with the factor 8
+    // of the unnormalized 2D transform.
+    output = input;
+    for (std::size_t y = 0; y < blockSize; y++)
+        forwardInteger(&output[y * blockSize], 1, constBits - pass1Bits);
+    for (std::size_t u = 0; u < blockSize; u++)
+        forwardInteger(&output[u], blockSize, constBits + pass1Bits + 3);
+}
+
+void FastDCT::itransform(const IntegerBlock &input, IntegerBlock &output) const
+{
+    output = input;
+    for (std::size_t u = 0; u < blockSize; u++)
+        inverseInteger(&output[u], blockSize, constBits - pass1Bits);
+    for (std::size_t y = 0; y < blockSize; y++)
+        inverseInteger(&output[y * blockSize], 1, constBits + pass1Bits + 3);
+}
+}
@@ -0,0 +1,73 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include "utils/HammingSearchKernel.hpp"
+
+#ifdef ADSI_ARCH_X86
+#    include <immintrin.h>
+
+namespace utils::hamming {
+namespace {
+/**
+ * @brief Count set bits of each 64-bit lane.
+ *
+ * Each nibble is counted by a byte shuffle of a 16 entry table, then the bytes of each lane are summed by
+ * a sum of absolute differences against zero.
+ */
+__m256i popcountLanes(__m256i value)
+{
+    const __m256i lookup { _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4) };
+    const __m256i lowNibbles { _mm256_set1_epi8(0x0f) };
+    const __m256i low { _mm256_and_si256(value, lowNibbles) };
+    const __m256i high { _mm256_and_si256(_mm256_srli_epi16(value, 4), lowNibbles) };
+    const __m256i counts { _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                           _mm256_shuffle_epi8(lookup, high)) };
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+}
+
+void distancesAVX2(const std::uint64_t *query, std::size_t words, const std::uint64_t *hashes,
+                   std::size_t count, std::uint16_t *distances)
+{
+    constexpr std::size_t lanes { 4 };
+    std::size_t idx { 0 };
+    if (words == 1) {
+        // Each vector holds 4 hashes, the counts of 4 vectors are packed into 16 distances. Packs work
+        // within 128-bit halves, so the last permutation puts the pairs of distances back in order.
+        const __m256i word { _mm256_set1_epi64x(static_cast<long long>(query[0])) };
+        const __m256i order { _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7) };
+        const auto countAt = [&](std::size_t first) {
+            const __m256i stored { _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(hashes + first)) };
+            return popcountLanes(_mm256_xor_si256(stored, word));
+        };
+        for (; idx + lanes * 4 <= count; idx += lanes * 4) {
+            const __m256i low { _mm256_packus_epi32(countAt(idx), countAt(idx + lanes)) };
+            const __m256i high { _mm256_packus_epi32(countAt(idx + lanes * 2),
+                                                     countAt(idx + lanes * 3)) };
+            const __m256i packed { _mm256_permutevar8x32_epi32(_mm256_packus_epi32(low, high),
+                                                               order) };
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(distances + idx), packed);
+        }
+    } else if (words == lanes) {
+        // Each vector holds a wide hash, the counts of its 4 words are summed across lanes.
+        const __m256i wide { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(query)) };
+        for (; idx < count; idx++) {
+            const __m256i stored { _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(hashes + idx * lanes)) };
+            const __m256i counts { popcountLanes(_mm256_xor_si256(stored, wide)) };
+            __m128i sum { _mm_add_epi64(_mm256_castsi256_si128(counts),
+                                        _mm256_extracti128_si256(counts, 1)) };
+            sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+            distances[idx] = static_cast<std::uint16_t>(_mm_cvtsi128_si32(sum));
+        }
+    }
+
+    if (idx < count)
+        distancesScalar(query, words, hashes + idx * words, count - idx, distances + idx);
+}
+}
+#endif // ADSI_ARCH_X86
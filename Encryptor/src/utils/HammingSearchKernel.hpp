@@ -0,0 +1,30 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/CPUFeatures.hpp"
+
+/**
+ * @brief Kernels of utils::HammingSearch, internal use only.
+ *
+ * Each instruction set lives in its own translation unit which compiled with the matching compiler flags,
+ * they must only be called after the CPU reported support of that instruction set. Every kernel takes the
+ * words of the query, the amount of words per hash, the words of the stored hashes, the amount of stored
+ * hashes and the distances to write.
+ */
+namespace utils::hamming {
+void distancesScalar(const std::uint64_t *query, std::size_t words, const std::uint64_t *hashes,
+                     std::size_t count, std::uint16_t *distances);
+
+#ifdef ADSI_ARCH_X86
+void distancesPOPCNT(const std::uint64_t *query, std::size_t words, const std::uint64_t *hashes,
+                     std::size_t count, std::uint16_t *distances);
+void distancesAVX2(const std::uint64_t *query, std::size_t words, const std::uint64_t *hashes,
+                   std::size_t count, std::uint16_t *distances);
+#endif // ADSI_ARCH_X86
+}
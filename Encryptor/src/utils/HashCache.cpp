@@ -0,0 +1,209 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QByteArray>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#include <cryptopp/sha.h>
+
+#include "utils/HashCache.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Header of the cache file, followed by the entries, in native byte order.
+ *
+ * Each entry holds the size and modification time of a file, the SHA-256 digest of its content, its
+ * average, difference, perceptual and wavelet hashes, then the length and the UTF-8 bytes of its absolute
+ * path.
+ */
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+constexpr char magic[8] { 'A', 'D', 'S', 'I', 'H', 'S', 'H', 'C' };
+constexpr std::uint32_t version { 2 };
+/**
+ * @brief Size of the digest of an entry.
+ */
+constexpr std::size_t digestSize { CryptoPP::SHA256::DIGESTSIZE };
+/**
+ * @brief Size of an entry without its path.
+ */
+constexpr std::size_t entrySize { 6 * sizeof(std::uint64_t) + digestSize + sizeof(std::uint32_t) };
+
+/**
+ * @brief Compute digest of the content of a file.
+ * @param path Path to the file.
+ * @return SHA-256 digest of the content, raw bytes.
+ * @throw std::runtime_error if the file could not be read.
+ */
+std::string digestOf(const QString &path)
+{
+    QFile file { path };
+    if (!file.open(QIODevice::ReadOnly)) throw std::runtime_error { "Unable to read the image." };
+
+    CryptoPP::SHA256 sha;
+    std::array<char, 1 << 16> buffer;
+    for (qint64 szRead; (szRead = file.read(buffer.data(), buffer.size())) > 0;)
+        sha.Update(reinterpret_cast<const CryptoPP::byte *>(buffer.data()),
+                   static_cast<std::size_t>(szRead));
+    std::string digest(digestSize, '\0');
+    sha.Final(reinterpret_cast<CryptoPP::byte *>(digest.data()));
+    return digest;
+}
+
+/**
+ * @brief Append an entry to the content of the cache file.
+ */
+void appendEntry(QByteArray &content, const std::string &path, std::uint64_t size,
+                 std::int64_t modified, const std::string &digest,
+                 const ImageFingerprint &fingerprint)
+{
+    const std::uint64_t state[] { size, static_cast<std::uint64_t>(modified) };
+    const std::uint64_t hashes[] { fingerprint.average.bits(), fingerprint.difference.bits(),
+                                   fingerprint.perceptual.bits(), fingerprint.wavelet.bits() };
+    const auto szPath { static_cast<std::uint32_t>(path.size()) };
+    content.append(reinterpret_cast<const char *>(state), sizeof(state));
+    content.append(digest.data(), static_cast<int>(digest.size()));
+    content.append(reinterpret_cast<const char *>(hashes), sizeof(hashes));
+    content.append(reinterpret_cast<const char *>(&szPath), sizeof(szPath));
+    content.append(path.data(), static_cast<int>(path.size()));
+}
+
+QByteArray headerContent()
+{
+    Header header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    return { reinterpret_cast<const char *>(&header), sizeof(header) };
+}
+}
+
+HashCache &HashCache::getInstance()
+{
+    static HashCache instance;
+    return instance;
+}
+
+bool HashCache::load(const QString &path)
+{
+    std::lock_guard lock { mutex_ };
+    path_ = path;
+    files_.clear();
+    fingerprints_.clear();
+
+    QFile file { path };
+    if (!file.exists()) return true;
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray content { file.readAll() };
+    file.close();
+
+    const auto szContent { static_cast<std::size_t>(content.size()) };
+    Header header {};
+    if (szContent >= sizeof(Header)) std::memcpy(&header, content.constData(), sizeof(header));
+    const bool valid { std::memcmp(header.magic, magic, sizeof(magic)) == 0
+                       && header.version == version };
+
+    std::size_t entries { 0 };
+    std::size_t offset { sizeof(Header) };
+    while (valid && offset + entrySize <= szContent) {
+        const char *entry { content.constData() + offset };
+        std::uint64_t state[2];
+        std::uint64_t hashes[4];
+        std::uint32_t szPath;
+        std::memcpy(state, entry, sizeof(state));
+        std::string digest { entry + sizeof(state), digestSize };
+        std::memcpy(hashes, entry + sizeof(state) + digestSize, sizeof(hashes));
+        std::memcpy(&szPath, entry + sizeof(state) + digestSize + sizeof(hashes), sizeof(szPath));
+        // An entry cut short by a crash while appending ends the file.
+        if (offset + entrySize + szPath > szContent) break;
+
+        std::string filePath { entry + entrySize, szPath };
+        fingerprints_[digest] = { PerceptualHash { hashes[0] }, PerceptualHash { hashes[1] },
+                                  PerceptualHash { hashes[2] }, PerceptualHash { hashes[3] } };
+        files_[std::move(filePath)] = { state[0], static_cast<std::int64_t>(state[1]),
+                                        std::move(digest) };
+        offset += entrySize + szPath;
+        entries++;
+    }
+    if (valid && offset == szContent && entries <= files_.size() * 2) return true;
+
+    // Drop overridden, cut short or unreadable entries, appending to such a file would lose new entries.
+    QByteArray compacted { headerContent() };
+    for (const auto &[filePath, state] : files_) {
+        appendEntry(compacted, filePath, state.size, state.modified, state.digest,
+                    fingerprints_.at(state.digest));
+    }
+    QSaveFile output { path };
+    if (!output.open(QIODevice::WriteOnly) || output.write(compacted) != compacted.size()
+        || !output.commit())
+        qDebug() << "Unable to compact the hash cache.";
+    return valid;
+}
+
+ImageFingerprint HashCache::fingerprintOf(const QString &path)
+{
+    const QFileInfo info { path };
+    if (!info.isFile()) throw std::runtime_error { "Unable to read the image." };
+
+    const auto absolutePath { info.absoluteFilePath().toStdString() };
+    FileState state { static_cast<std::uint64_t>(info.size()),
+                      info.lastModified().toMSecsSinceEpoch(), {} };
+    {
+        std::lock_guard lock { mutex_ };
+        const auto file { files_.find(absolutePath) };
+        if (file != files_.end() && file->second.size == state.size
+            && file->second.modified == state.modified)
+            return fingerprints_.at(file->second.digest);
+    }
+
+    // The file changed or is new, its content may still have been fingerprinted under another path.
+    state.digest = digestOf(path);
+    std::optional<ImageFingerprint> cached;
+    {
+        std::lock_guard lock { mutex_ };
+        const auto fingerprint { fingerprints_.find(state.digest) };
+        if (fingerprint != fingerprints_.end()) cached = fingerprint->second;
+    }
+
+    const auto fingerprint { cached ? *cached : ImageFingerprint::fromFile(path) };
+    store(absolutePath, state, fingerprint);
+    return fingerprint;
+}
+
+std::size_t HashCache::size() const
+{
+    std::lock_guard lock { mutex_ };
+    return fingerprints_.size();
+}
+
+void HashCache::store(const std::string &path, const FileState &state,
+                      const ImageFingerprint &fingerprint)
+{
+    std::lock_guard lock { mutex_ };
+    files_[path] = state;
+    fingerprints_.try_emplace(state.digest, fingerprint);
+    if (path_.isEmpty()) return;
+
+    QFile file { path_ };
+    QByteArray content { file.exists() ? QByteArray {} : headerContent() };
+    appendEntry(content, path, state.size, state.modified, state.digest, fingerprint);
+    if (!file.open(QIODevice::Append) || file.write(content) != content.size())
+        qDebug() << "Unable to save the hash cache.";
+}
+}
@@ -0,0 +1,114 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "utils/ImageFingerprint.hpp"
+
+namespace utils {
+/**
+ * @brief Singleton object that caches the fingerprints of image files across runs.
+ *
+ * A file whose size and modification time are unchanged since it was last fingerprinted is answered with a
+ * single stat and a table lookup. Otherwise the SHA-256 digest of its content is computed, so copies,
+ * renames and touched files are still answered without decoding them, only new content is fingerprinted.
+ * Contents are told apart by a cryptographic digest, so a file crafted to look like a cached one could
+ * not reuse its fingerprint.
+ *
+ * Entries are appended to the cache file as they are computed, a later entry of the same path overrides the
+ * earlier ones, and the file is compacted when loaded. Every member may be called from any thread.
+ */
+class HashCache
+{
+public:
+    HashCache(const HashCache &) = delete;
+    HashCache(HashCache &&) = delete;
+    HashCache &operator=(const HashCache &) = delete;
+    HashCache &operator=(HashCache &&) = delete;
+
+    /**
+     * @brief Get unique instance of HashCache.
+     * @return Unique instance of HashCache.
+     */
+    static HashCache &getInstance();
+
+    /**
+     * @brief Replace cached fingerprints with the content of a file.
+     * @param path Path to the file, computed fingerprints are appended into it.
+     * @return True if the file is loaded or does not exist yet, false if it is not a valid cache, in which
+     * case the cache is empty.
+     */
+    bool load(const QString &path);
+    /**
+     * @brief Get fingerprint of an image file, computed only if its content is not cached.
+     * @param path Path to the image.
+     * @return Fingerprint of the image.
+     * @throw std::runtime_error if the file could not be read or is not a valid image.
+     */
+    ImageFingerprint fingerprintOf(const QString &path);
+
+public: // Accessors
+    /**
+     * @brief Get amount of distinct contents cached.
+     */
+    std::size_t size() const;
+
+private:
+    /**
+     * @brief State of a file when it was last fingerprinted.
+     */
+    struct FileState
+    {
+        /**
+         * @brief Size of the file in bytes.
+         */
+        std::uint64_t size;
+        /**
+         * @brief Modification time of the file in milliseconds since epoch.
+         */
+        std::int64_t modified;
+        /**
+         * @brief SHA-256 digest of the content of the file, raw bytes.
+         */
+        std::string digest;
+    };
+
+private:
+    HashCache() = default;
+
+    /**
+     * @brief Cache the fingerprint of a file and append it to the cache file.
+     * @param path Absolute path to the file, UTF-8 encoded.
+     * @param state State of the file.
+     * @param fingerprint Fingerprint of the file.
+     */
+    void store(const std::string &path, const FileState &state, const ImageFingerprint &fingerprint);
+
+private:
+    /**
+     * @brief Guard of every member.
+     */
+    mutable std::mutex mutex_;
+    /**
+     * @brief File of the cache.
+     */
+    QString path_;
+    /**
+     * @brief Last known state of each file, by absolute path.
+     */
+    std::unordered_map<std::string, FileState> files_;
+    /**
+     * @brief Fingerprint of each content, by digest.
+     */
+    std::unordered_map<std::string, ImageFingerprint> fingerprints_;
+};
+}
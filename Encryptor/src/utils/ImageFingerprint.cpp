@@ -0,0 +1,101 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+#include "utils/ImageFingerprint.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Width and height of the hashed grid, so each hash has 64 bits.
+ */
+constexpr int gridSize { PerceptualHash::hashSize };
+
+/**
+ * @brief Hash the cells of a grid above their average.
+ */
+PerceptualHash hashAboveMean(const std::array<int, gridSize * gridSize> &grid)
+{
+    const int total { std::accumulate(grid.begin(), grid.end(), 0) };
+
+    std::uint64_t bits { 0 };
+    for (auto cell : grid) bits = (bits << 1) | (cell * gridSize * gridSize > total ? 1 : 0);
+    return PerceptualHash { bits };
+}
+
+/**
+ * @brief Hash the cells of a grid above their median, the mean of the two middle cells.
+ */
+PerceptualHash hashAboveMedian(const std::array<int, gridSize * gridSize> &grid)
+{
+    auto sorted = grid;
+    constexpr std::size_t middle { gridSize * gridSize / 2 };
+    std::nth_element(sorted.begin(), sorted.begin() + middle, sorted.end());
+    const int twiceMedian { sorted[middle]
+                            + *std::max_element(sorted.begin(), sorted.begin() + middle) };
+
+    std::uint64_t bits { 0 };
+    for (auto cell : grid) bits = (bits << 1) | (cell * 2 > twiceMedian ? 1 : 0);
+    return PerceptualHash { bits };
+}
+}
+
+ImageFingerprint ImageFingerprint::fromImage(const QImage &image)
+{
+    return fromThumbnail(ImageThumbnail::fromImage(image));
+}
+
+ImageFingerprint ImageFingerprint::fromFile(const QString &path)
+{
+    return fromThumbnail(ImageThumbnail::fromFile(path));
+}
+
+ImageFingerprint ImageFingerprint::fromThumbnail(const ImageThumbnail &thumbnail)
+{
+    const auto &samples = thumbnail.samples();
+    constexpr int szThumbnail { ImageThumbnail::size };
+    ImageFingerprint result;
+
+    const auto averaged =
+            ImageThumbnail::resize(samples.data(), szThumbnail, szThumbnail, gridSize, gridSize);
+    std::array<int, gridSize * gridSize> grid;
+    std::copy(averaged.begin(), averaged.end(), grid.begin());
+    result.average = hashAboveMean(grid);
+
+    const auto gradients = ImageThumbnail::resize(samples.data(), szThumbnail, szThumbnail,
+                                                  gridSize + 1, gridSize);
+    std::uint64_t bits { 0 };
+    for (int y = 0; y < gridSize; y++) {
+        for (int x = 0; x < gridSize; x++) {
+            const auto left = gradients[y * (gridSize + 1) + x];
+            bits = (bits << 1) | (gradients[y * (gridSize + 1) + x + 1] > left ? 1 : 0);
+        }
+    }
+    result.difference = PerceptualHash { bits };
+
+    result.perceptual = PerceptualHash::fromThumbnail(thumbnail);
+
+    // The low pass band of an orthonormal Haar transform is the sum of each block scaled by a constant,
+    // and removing the mean of the image as imagehash.whash does shifts every coefficient alike. Neither
+    // changes which coefficients are above the median, so the sums of the blocks are compared directly.
+    constexpr int szBlock { szThumbnail / gridSize };
+    grid.fill(0);
+    for (int y = 0; y < szThumbnail; y++) {
+        for (int x = 0; x < szThumbnail; x++)
+            grid[y / szBlock * gridSize + x / szBlock] += samples[y * szThumbnail + x];
+    }
+    result.wavelet = hashAboveMedian(grid);
+    return result;
+}
+
+ImageFingerprint::Distance ImageFingerprint::distance(const ImageFingerprint &rhs) const
+{
+    return { average.distance(rhs.average), difference.distance(rhs.difference),
+             perceptual.distance(rhs.perceptual), wavelet.distance(rhs.wavelet) };
+}
+}
@@ -0,0 +1,91 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QImage>
+#include <QString>
+
+#include "utils/ImageThumbnail.hpp"
+#include "utils/PerceptualHash.hpp"
+
+namespace utils {
+/**
+ * @brief Average, difference, perceptual and wavelet hashes of an image, computed from a single thumbnail.
+ *
+ * Each hash catches different edits: the average hash follows the overall brightness, the difference hash
+ * the gradients, the perceptual hash the low frequencies and the wavelet hash the coarse blocks. All of
+ * them are 64 bits and stored in a PerceptualHash, only @p perceptual is bit compatible with imagehash.
+ */
+struct ImageFingerprint
+{
+    /**
+     * @brief Hamming distance of each hash between two fingerprints.
+     */
+    struct Distance
+    {
+        /**
+         * @brief Distance of the average hashes.
+         */
+        int average;
+        /**
+         * @brief Distance of the difference hashes.
+         */
+        int difference;
+        /**
+         * @brief Distance of the perceptual hashes.
+         */
+        int perceptual;
+        /**
+         * @brief Distance of the wavelet hashes.
+         */
+        int wavelet;
+    };
+
+    /**
+     * @brief Fingerprint an image.
+     * @param image Image to fingerprint, must not be null.
+     * @return Fingerprint of the image.
+     * @throw std::invalid_argument if @p image is null.
+     */
+    static ImageFingerprint fromImage(const QImage &image);
+    /**
+     * @brief Fingerprint an image file, which is decoded once for every hash.
+     * @param path Path to the image.
+     * @return Fingerprint of the image.
+     * @throw std::runtime_error if the file could not be read or is not a valid image.
+     */
+    static ImageFingerprint fromFile(const QString &path);
+    /**
+     * @brief Fingerprint the thumbnail of an image.
+     * @param thumbnail Thumbnail of the image.
+     * @return Fingerprint of the image.
+     */
+    static ImageFingerprint fromThumbnail(const ImageThumbnail &thumbnail);
+
+    /**
+     * @brief Compare every hash of two fingerprints.
+     * @param rhs Fingerprint to compare with.
+     * @return Distance of each hash, in [0, 64].
+     */
+    Distance distance(const ImageFingerprint &rhs) const;
+
+    /**
+     * @brief Whether each pixel of the thumbnail resized to 8x8 is brighter than the mean.
+     */
+    PerceptualHash average;
+    /**
+     * @brief Whether each pixel of the thumbnail resized to 9x8 is darker than its right neighbour.
+     */
+    PerceptualHash difference;
+    /**
+     * @brief Perceptual hash, as PerceptualHash::fromThumbnail(const ImageThumbnail &) computes it.
+     */
+    PerceptualHash perceptual;
+    /**
+     * @brief Whether each low pass coefficient of a 2-level Haar transform is greater than their median.
+     */
+    PerceptualHash wavelet;
+};
+}
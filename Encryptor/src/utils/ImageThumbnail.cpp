@@ -0,0 +1,290 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QColor>
+#include <QFile>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include <boost/math/constants/constants.hpp>
+#include <boost/scope_exit.hpp>
+
+#include "utils/ImageThumbnail.hpp"
+#include "utils/JPEGSupport.hpp"
+#include "utils/ScaledImageReader.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Fractional bits of the resampling coefficients, as in Pillow.
+ */
+constexpr int precisionBits { 32 - 8 - 2 };
+/**
+ * @brief Half width of the Lanczos filter.
+ */
+constexpr double lanczosSupport { 3.0 };
+
+/**
+ * @brief Luminance of a pixel, as Pillow convert("L") computes it.
+ */
+std::uint8_t luminance(int red, int green, int blue)
+{
+    return static_cast<std::uint8_t>((red * 19595 + green * 38470 + blue * 7471 + 0x8000) >> 16);
+}
+
+/**
+ * @brief Normalized sinc function.
+ */
+double sinc(double x)
+{
+    if (x == 0.0) return 1.0;
+
+    x *= boost::math::double_constants::pi;
+    return std::sin(x) / x;
+}
+
+/**
+ * @brief Lanczos filter, sinc windowed by a wider sinc.
+ */
+double lanczos(double x)
+{
+    return -lanczosSupport <= x && x < lanczosSupport ? sinc(x) * sinc(x / lanczosSupport) : 0.0;
+}
+
+/**
+ * @brief Fixed point coefficients which resample a line of samples, as Pillow precomputes them.
+ */
+struct Resampler
+{
+    /**
+     * @brief Compute coefficients.
+     * @param szIn Amount of samples of a source line.
+     * @param szOut Amount of samples of a resampled line.
+     */
+    Resampler(int szIn, int szOut)
+    {
+        const double scale { static_cast<double>(static_cast<float>(szIn)) / szOut };
+        const double filterScale { std::max(scale, 1.0) };
+        const double support { lanczosSupport * filterScale };
+        const double invFilterScale { 1.0 / filterScale };
+        szKernel = static_cast<int>(std::ceil(support)) * 2 + 1;
+
+        bounds.resize(static_cast<std::size_t>(szOut) * 2);
+        kernels.resize(static_cast<std::size_t>(szOut) * szKernel);
+        std::vector<double> weights(static_cast<std::size_t>(szKernel));
+        for (int idxOut = 0; idxOut < szOut; idxOut++) {
+            const double center { (idxOut + 0.5) * scale };
+            const int first { std::max(static_cast<int>(center - support + 0.5), 0) };
+            const int count { std::min(static_cast<int>(center + support + 0.5), szIn) - first };
+
+            double total { 0.0 };
+            for (int idx = 0; idx < count; idx++) {
+                weights[idx] = lanczos((idx + first - center + 0.5) * invFilterScale);
+                total += weights[idx];
+            }
+
+            auto kernel = &kernels[static_cast<std::size_t>(idxOut) * szKernel];
+            for (int idx = 0; idx < count; idx++) {
+                const double weight { total != 0.0 ? weights[idx] / total : weights[idx] };
+                kernel[idx] = static_cast<std::int32_t>(
+                        (weight < 0 ? -0.5 : 0.5) + weight * (1 << precisionBits));
+            }
+            bounds[idxOut * 2] = first;
+            bounds[idxOut * 2 + 1] = count;
+        }
+    }
+
+    /**
+     * @brief Resample a line of samples.
+     * @param src First sample of the source line.
+     * @param stride Distance between two samples of the source line.
+     * @param idxOut Index of the resampled sample.
+     * @param idxSrc Index of the source sample at @p src.
+     * @return Resampled sample.
+     */
+    std::uint8_t apply(const std::uint8_t *src, std::ptrdiff_t stride, int idxOut,
+                       int idxSrc = 0) const
+    {
+        const auto kernel = &kernels[static_cast<std::size_t>(idxOut) * szKernel];
+        const int first { bounds[idxOut * 2] - idxSrc };
+        std::int32_t sum { 1 << (precisionBits - 1) };
+        for (int idx = 0; idx < bounds[idxOut * 2 + 1]; idx++)
+            sum += src[(first + idx) * stride] * kernel[idx];
+
+        return static_cast<std::uint8_t>(std::clamp(sum >> precisionBits, 0, 255));
+    }
+
+    /**
+     * @brief Amount of coefficients reserved per resampled sample.
+     */
+    int szKernel;
+    /**
+     * @brief First source sample and amount of source samples of each resampled sample.
+     */
+    std::vector<int> bounds;
+    /**
+     * @brief Coefficients of each resampled sample, szKernel apart.
+     */
+    std::vector<std::int32_t> kernels;
+};
+
+/**
+ * @brief Decode a JPEG file into luminance samples, as Pillow opens and converts it.
+ * @param path Path to the file, in the local 8-bit encoding.
+ * @param minSize Smallest width and height of the decoded samples, libjpeg scales larger images down.
+ * @param samples Decoded samples, @p width per row.
+ * @param width Width of the image.
+ * @param height Height of the image.
+ * @return False if the file is not a JPEG file of luminance or color, so it has to be loaded otherwise.
+ * @throw std::runtime_error if the file is a corrupted JPEG file.
+ */
+bool decodeJPEG(const std::string &path, int minSize, std::vector<std::uint8_t> &samples,
+                int &width, int &height)
+{
+    // Every object is built before setjmp, so a jump from libjpeg never skip a destructor.
+    std::FILE *file { std::fopen(path.c_str(), "rb") };
+    if (file == nullptr) return false;
+
+    std::vector<JSAMPLE> line;
+    JSAMPROW lineRow { nullptr };
+    JPEGErrorManager error;
+    jpeg_decompress_struct decompress;
+    decompress.err = error.install();
+    jpeg_create_decompress(&decompress);
+    BOOST_SCOPE_EXIT_ALL(&)
+    {
+        jpeg_destroy_decompress(&decompress);
+        std::fclose(file);
+    };
+
+    std::array<unsigned char, 2> magic {};
+    if (std::fread(magic.data(), 1, magic.size(), file) != magic.size() || magic[0] != 0xff
+        || magic[1] != 0xd8)
+        return false;
+    std::rewind(file);
+
+    if (setjmp(error.jump))
+        throw std::runtime_error { std::string { "Unable to read JPEG: " } + error.message };
+
+    jpeg_stdio_src(&decompress, file);
+    jpeg_read_header(&decompress, TRUE);
+    const bool isGrayscale { decompress.jpeg_color_space == JCS_GRAYSCALE };
+    if (!isGrayscale && decompress.num_components != 3) return false;
+
+    const QSize szImage { static_cast<int>(decompress.image_width),
+                          static_cast<int>(decompress.image_height) };
+    decompress.scale_num = 1;
+    decompress.scale_denom = static_cast<unsigned int>(
+            ScaledImageReader::scaleDenominator(szImage, { minSize, minSize }));
+    decompress.out_color_space = isGrayscale ? JCS_GRAYSCALE : JCS_RGB;
+    jpeg_start_decompress(&decompress);
+    width = static_cast<int>(decompress.output_width);
+    height = static_cast<int>(decompress.output_height);
+    samples.resize(static_cast<std::size_t>(width) * height);
+    line.resize(static_cast<std::size_t>(width) * decompress.output_components);
+    lineRow = line.data();
+
+    for (int y = 0; y < height; y++) {
+        jpeg_read_scanlines(&decompress, &lineRow, 1);
+        auto row = &samples[static_cast<std::size_t>(y) * width];
+        if (isGrayscale) {
+            std::copy(line.begin(), line.end(), row);
+            continue;
+        }
+        for (int x = 0; x < width; x++)
+            row[x] = luminance(line[x * 3], line[x * 3 + 1], line[x * 3 + 2]);
+    }
+
+    jpeg_finish_decompress(&decompress);
+    return true;
+}
+}
+
+ImageThumbnail ImageThumbnail::fromImage(const QImage &image)
+{
+    if (image.isNull())
+        throw std::invalid_argument { "Parameter image must not be null but it seems to be." };
+
+    const auto pixels = image.convertToFormat(QImage::Format_ARGB32);
+    std::vector<std::uint8_t> samples(static_cast<std::size_t>(pixels.width()) * pixels.height());
+    for (int y = 0; y < pixels.height(); y++) {
+        auto line = reinterpret_cast<const QRgb *>(pixels.constScanLine(y));
+        auto row = &samples[static_cast<std::size_t>(y) * pixels.width()];
+        for (int x = 0; x < pixels.width(); x++)
+            row[x] = luminance(qRed(line[x]), qGreen(line[x]), qBlue(line[x]));
+    }
+    return fromLuminance(samples.data(), pixels.width(), pixels.height());
+}
+
+ImageThumbnail ImageThumbnail::fromFile(const QString &path)
+{
+    std::vector<std::uint8_t> samples;
+    int width { 0 };
+    int height { 0 };
+    if (decodeJPEG(QFile::encodeName(path).toStdString(), minDecodeSize, samples, width, height))
+        return fromLuminance(samples.data(), width, height);
+
+    const QImage image { path };
+    if (image.isNull())
+        throw std::runtime_error { "Unable to read image: " + path.toStdString() };
+
+    return fromImage(image);
+}
+
+std::vector<std::uint8_t> ImageThumbnail::resize(const std::uint8_t *samples, int width,
+                                                 int height, int szWidth, int szHeight)
+{
+    // Only the rows used by the vertical pass are resized horizontally.
+    const Resampler horizontal { width, szWidth };
+    const Resampler vertical { height, szHeight };
+    const int firstRow { vertical.bounds.front() };
+    const int endRow { vertical.bounds[szHeight * 2 - 2] + vertical.bounds[szHeight * 2 - 1] };
+
+    std::vector<std::uint8_t> rows;
+    const std::uint8_t *src { samples };
+    std::ptrdiff_t stride { width };
+    int idxSrcRow { 0 };
+    if (width != szWidth) {
+        rows.resize(static_cast<std::size_t>(endRow - firstRow) * szWidth);
+        for (int y = firstRow; y < endRow; y++) {
+            for (int x = 0; x < szWidth; x++) {
+                rows[static_cast<std::size_t>(y - firstRow) * szWidth + x] =
+                        horizontal.apply(samples + static_cast<std::ptrdiff_t>(y) * width, 1, x);
+            }
+        }
+        src = rows.data();
+        stride = szWidth;
+        idxSrcRow = firstRow;
+    }
+
+    std::vector<std::uint8_t> result(static_cast<std::size_t>(szWidth) * szHeight);
+    for (int y = 0; y < szHeight; y++) {
+        for (int x = 0; x < szWidth; x++) {
+            result[static_cast<std::size_t>(y) * szWidth + x] = height != szHeight
+                    ? vertical.apply(src + x, stride, y, idxSrcRow)
+                    : src[static_cast<std::ptrdiff_t>(y - idxSrcRow) * stride + x];
+        }
+    }
+    return result;
+}
+
+const ImageThumbnail::Samples &ImageThumbnail::samples() const
+{
+    return samples_;
+}
+
+ImageThumbnail ImageThumbnail::fromLuminance(const std::uint8_t *samples, int width, int height)
+{
+    const auto resized = resize(samples, width, height, size, size);
+
+    ImageThumbnail result;
+    std::copy(resized.begin(), resized.end(), result.samples_.begin());
+    return result;
+}
+}
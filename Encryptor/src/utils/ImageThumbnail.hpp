@@ -0,0 +1,98 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QImage>
+#include <QString>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+/**
+ * @brief Small luminance copy of an image, which every image hash is computed from.
+ *
+ * The image is reduced to 8-bit luminance as Pillow convert("L") does, then resized to size x size with the
+ * fixed point Lanczos filter of Pillow. Decoding and resizing are the expensive steps of hashing, so an image
+ * is reduced once and all its hashes are derived from the thumbnail.
+ */
+class ImageThumbnail
+{
+public:
+    /**
+     * @brief Width and height of the thumbnail.
+     */
+    static constexpr int size { 32 };
+    /**
+     * @brief Smallest width and height JPEG files are decoded at before they are resized.
+     */
+    static constexpr int minDecodeSize { size * 4 };
+
+    /**
+     * @brief Samples of the thumbnail, in row major order.
+     */
+    using Samples = std::array<std::uint8_t, size * size>;
+
+public:
+    /**
+     * @brief Reduce an image.
+     * @param image Image to reduce, must not be null.
+     * @return Thumbnail of the image.
+     * @throw std::invalid_argument if @p image is null.
+     */
+    static ImageThumbnail fromImage(const QImage &image);
+    /**
+     * @brief Reduce an image file.
+     *
+     * JPEG files are decoded by libjpeg with the settings of Pillow, scaled down by libjpeg as long as they
+     * stay at least minDecodeSize wide and high. Scaling skips most of the decoding of a large file, at
+     * the cost of samples which differ slightly from the ones Pillow sees. Other files are loaded by QImage.
+     *
+     * @param path Path to the image.
+     * @return Thumbnail of the image.
+     * @throw std::runtime_error if the file could not be read or is not a valid image.
+     */
+    static ImageThumbnail fromFile(const QString &path);
+
+    /**
+     * @brief Resize luminance samples with the Lanczos filter, as Pillow resize() does.
+     *
+     * Samples are resized horizontally then vertically and rounded to 8 bits between the passes, a pass is
+     * skipped when its axis already has the size.
+     *
+     * @param samples Samples in row major order, @p width per row.
+     * @param width Width of the samples.
+     * @param height Height of the samples.
+     * @param szWidth Width of the result.
+     * @param szHeight Height of the result.
+     * @return Resized samples in row major order, @p szWidth per row.
+     */
+    static std::vector<std::uint8_t> resize(const std::uint8_t *samples, int width, int height,
+                                            int szWidth, int szHeight);
+
+public: // Accessors
+    /**
+     * @brief Get samples of the thumbnail.
+     */
+    const Samples &samples() const;
+
+private:
+    /**
+     * @brief Reduce luminance samples.
+     * @param samples Samples in row major order, @p width per row.
+     * @param width Width of the image.
+     * @param height Height of the image.
+     * @return Thumbnail of the samples.
+     */
+    static ImageThumbnail fromLuminance(const std::uint8_t *samples, int width, int height);
+
+private:
+    /**
+     * @brief Samples of the thumbnail.
+     */
+    Samples samples_;
+};
+}
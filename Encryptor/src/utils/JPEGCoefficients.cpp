@@ -0,0 +1,119 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "utils/JPEGCoefficients.hpp"
+#include "utils/JPEGSupport.hpp"
+
+namespace utils {
+struct JPEGCoefficients::State
+{
+    /**
+     * @brief Content of the file, libjpeg read from it directly.
+     */
+    std::vector<std::byte> jpeg;
+    /**
+     * @brief Error manager of @p decompress.
+     */
+    JPEGErrorManager error;
+    /**
+     * @brief Decompressor which own the coefficients.
+     */
+    jpeg_decompress_struct decompress;
+    /**
+     * @brief Coefficients of every component.
+     */
+    jvirt_barray_ptr *coefficients { nullptr };
+
+    ~State()
+    {
+        jpeg_destroy_decompress(&decompress);
+    }
+};
+
+JPEGCoefficients::JPEGCoefficients(const std::vector<std::byte> &jpeg)
+    : state_ { std::make_unique<State>() }
+{
+    auto &state = *state_;
+    state.jpeg = jpeg;
+    state.decompress.err = state.error.install();
+    jpeg_create_decompress(&state.decompress);
+
+    if (setjmp(state.error.jump))
+        throw std::runtime_error { std::string { "Unable to read JPEG: " } + state.error.message };
+
+    jpeg_mem_src(&state.decompress, reinterpret_cast<const unsigned char *>(state.jpeg.data()),
+                 static_cast<unsigned long>(state.jpeg.size()));
+    saveCopiedMarkers(state.decompress);
+    jpeg_read_header(&state.decompress, TRUE);
+    state.coefficients = jpeg_read_coefficients(&state.decompress);
+}
+
+JPEGCoefficients::JPEGCoefficients(JPEGCoefficients &&) noexcept = default;
+
+JPEGCoefficients &JPEGCoefficients::operator=(JPEGCoefficients &&) noexcept = default;
+
+JPEGCoefficients::~JPEGCoefficients() = default;
+
+std::vector<std::byte> JPEGCoefficients::save() const
+{
+    auto &state = *state_;
+    JPEGErrorManager error;
+    jpeg_compress_struct compress;
+    compress.err = error.install();
+    jpeg_create_compress(&compress);
+
+    unsigned char *buffer { nullptr };
+    unsigned long szBuffer { 0 };
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&compress);
+        std::free(buffer);
+        throw std::runtime_error { std::string { "Unable to write JPEG: " } + error.message };
+    }
+
+    jpeg_mem_dest(&compress, &buffer, &szBuffer);
+    jpeg_copy_critical_parameters(&state.decompress, &compress);
+    jpeg_write_coefficients(&compress, state.coefficients);
+    writeCopiedMarkers(state.decompress, compress);
+    jpeg_finish_compress(&compress);
+    jpeg_destroy_compress(&compress);
+
+    auto begBuffer = reinterpret_cast<const std::byte *>(buffer);
+    std::vector<std::byte> result { begBuffer, begBuffer + szBuffer };
+    std::free(buffer);
+    return result;
+}
+
+int JPEGCoefficients::blockColumns() const
+{
+    return static_cast<int>(state_->decompress.comp_info[0].width_in_blocks);
+}
+
+int JPEGCoefficients::blockRows() const
+{
+    return static_cast<int>(state_->decompress.comp_info[0].height_in_blocks);
+}
+
+std::int16_t *JPEGCoefficients::block(int col, int row)
+{
+    auto &decompress = state_->decompress;
+    auto blockRow = (*decompress.mem->access_virt_barray)(
+            reinterpret_cast<j_common_ptr>(&decompress), state_->coefficients[0],
+            static_cast<JDIMENSION>(row), 1, TRUE);
+    return blockRow[0][col];
+}
+
+const std::int16_t *JPEGCoefficients::block(int col, int row) const
+{
+    auto &decompress = state_->decompress;
+    auto blockRow = (*decompress.mem->access_virt_barray)(
+            reinterpret_cast<j_common_ptr>(&decompress), state_->coefficients[0],
+            static_cast<JDIMENSION>(row), 1, FALSE);
+    return blockRow[0][col];
+}
+}
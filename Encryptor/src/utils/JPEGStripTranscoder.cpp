@@ -0,0 +1,172 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QColor>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/scope_exit.hpp>
+
+#include "utils/JPEGStripTranscoder.hpp"
+#include "utils/JPEGSupport.hpp"
+
+namespace utils {
+struct JPEGStripTranscoder::State
+{
+    /**
+     * @brief Error manager of @p decompress.
+     */
+    JPEGErrorManager error;
+    /**
+     * @brief Decompressor of the source file.
+     */
+    jpeg_decompress_struct decompress;
+    /**
+     * @brief Source file, nullptr if it is not opened.
+     */
+    std::FILE *src { nullptr };
+
+    ~State()
+    {
+        jpeg_destroy_decompress(&decompress);
+        if (src != nullptr) std::fclose(src);
+    }
+};
+
+JPEGStripTranscoder::JPEGStripTranscoder(const std::string &srcPath)
+    : state_ { std::make_unique<State>() }
+{
+    auto &state = *state_;
+    state.decompress.err = state.error.install();
+    jpeg_create_decompress(&state.decompress);
+
+    state.src = std::fopen(srcPath.c_str(), "rb");
+    if (state.src == nullptr) throw std::runtime_error { "Unable to open JPEG: " + srcPath };
+
+    if (setjmp(state.error.jump))
+        throw std::runtime_error { std::string { "Unable to read JPEG: " } + state.error.message };
+
+    jpeg_stdio_src(&state.decompress, state.src);
+    saveCopiedMarkers(state.decompress);
+    jpeg_read_header(&state.decompress, TRUE);
+    // No row of a multi-scan file, such as a progressive one, is complete before its last scan is read,
+    // libjpeg would buffer the coefficients of the whole image.
+    if (jpeg_has_multiple_scans(&state.decompress))
+        throw std::domain_error { "JPEG with multiple scans could not be transcoded strip by strip: "
+                                  + srcPath };
+}
+
+JPEGStripTranscoder::JPEGStripTranscoder(JPEGStripTranscoder &&) noexcept = default;
+
+JPEGStripTranscoder &JPEGStripTranscoder::operator=(JPEGStripTranscoder &&) noexcept = default;
+
+JPEGStripTranscoder::~JPEGStripTranscoder() = default;
+
+void JPEGStripTranscoder::transcode(const std::string &outPath, const StripEditor &edit,
+                                    int quality)
+{
+    auto &state = *state_;
+    auto &decompress = state.decompress;
+    const int cols { width() };
+    const int rows { height() };
+    const int szStrip { stripHeight() };
+
+    // Every object is built before setjmp, so a jump from libjpeg never skip a destructor.
+    std::vector<QRgb> strip(static_cast<std::size_t>(cols) * szStrip);
+    std::vector<JSAMPLE> line(static_cast<std::size_t>(cols) * 3);
+    JSAMPROW lineRow { line.data() };
+
+    JPEGErrorManager error;
+    jpeg_compress_struct compress;
+    compress.err = error.install();
+    jpeg_create_compress(&compress);
+
+    std::FILE *out { std::fopen(outPath.c_str(), "wb") };
+    bool done { false };
+    BOOST_SCOPE_EXIT_ALL(&)
+    {
+        jpeg_destroy_compress(&compress);
+        if (out == nullptr) return;
+
+        std::fclose(out);
+        if (!done) std::remove(outPath.c_str());
+    };
+    if (out == nullptr) throw std::runtime_error { "Unable to open file to write: " + outPath };
+
+    if (setjmp(state.error.jump))
+        throw std::runtime_error { std::string { "Unable to read JPEG: " } + state.error.message };
+
+    if (setjmp(error.jump))
+        throw std::runtime_error { std::string { "Unable to write JPEG: " } + error.message };
+
+    decompress.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&decompress);
+
+    jpeg_stdio_dest(&compress, out);
+    compress.image_width = decompress.output_width;
+    compress.image_height = decompress.output_height;
+    compress.input_components = 3;
+    compress.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&compress);
+    jpeg_set_quality(&compress, quality, TRUE);
+    if (decompress.jpeg_color_space == JCS_GRAYSCALE) {
+        jpeg_set_colorspace(&compress, JCS_GRAYSCALE);
+    } else if (decompress.num_components == compress.num_components) {
+        for (int idx = 0; idx < compress.num_components; idx++) {
+            compress.comp_info[idx].h_samp_factor = decompress.comp_info[idx].h_samp_factor;
+            compress.comp_info[idx].v_samp_factor = decompress.comp_info[idx].v_samp_factor;
+        }
+    }
+    compress.density_unit = decompress.density_unit;
+    compress.X_density = decompress.X_density;
+    compress.Y_density = decompress.Y_density;
+    jpeg_start_compress(&compress, TRUE);
+    writeCopiedMarkers(decompress, compress);
+
+    const auto bytesPerLine = static_cast<std::ptrdiff_t>(cols * sizeof(QRgb));
+    for (int firstRow = 0; firstRow < rows; firstRow += szStrip) {
+        const int szRows { std::min(szStrip, rows - firstRow) };
+        for (int y = 0; y < szRows; y++) {
+            jpeg_read_scanlines(&decompress, &lineRow, 1);
+            auto pixels = strip.data() + static_cast<std::ptrdiff_t>(y) * cols;
+            for (int x = 0; x < cols; x++)
+                pixels[x] = qRgb(line[x * 3], line[x * 3 + 1], line[x * 3 + 2]);
+        }
+
+        edit(reinterpret_cast<uchar *>(strip.data()), bytesPerLine, firstRow, szRows);
+
+        for (int y = 0; y < szRows; y++) {
+            auto pixels = strip.data() + static_cast<std::ptrdiff_t>(y) * cols;
+            for (int x = 0; x < cols; x++) {
+                line[x * 3] = static_cast<JSAMPLE>(qRed(pixels[x]));
+                line[x * 3 + 1] = static_cast<JSAMPLE>(qGreen(pixels[x]));
+                line[x * 3 + 2] = static_cast<JSAMPLE>(qBlue(pixels[x]));
+            }
+            jpeg_write_scanlines(&compress, &lineRow, 1);
+        }
+    }
+
+    jpeg_finish_compress(&compress);
+    jpeg_finish_decompress(&decompress);
+    done = true;
+}
+
+int JPEGStripTranscoder::width() const
+{
+    return static_cast<int>(state_->decompress.image_width);
+}
+
+int JPEGStripTranscoder::height() const
+{
+    return static_cast<int>(state_->decompress.image_height);
+}
+
+int JPEGStripTranscoder::stripHeight() const
+{
+    return state_->decompress.max_v_samp_factor * DCTSIZE;
+}
+}
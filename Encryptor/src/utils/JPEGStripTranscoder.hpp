@@ -0,0 +1,92 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QtGlobal>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace utils {
+/**
+ * @brief Decode a JPEG file strip by strip, let the caller edit each strip, and encode it into another file.
+ *
+ * Only a strip of pixels is held at a time, so peak memory is bounded by the width of the image instead of
+ * its area. That only holds for a file stored in a single scan, a progressive file, or any file whose
+ * components are stored in separate scans, is rejected as libjpeg would buffer its whole image. Strips
+ * are whole MCU rows, which is always a multiple of 8 rows, only the last strip may be shorter. The
+ * written file keeps the sampling, density and markers of the source.
+ */
+class JPEGStripTranscoder
+{
+public:
+    /**
+     * @brief Function which edit a strip.
+     *
+     * Receives the pixels of the strip in QImage::Format_ARGB32 layout, the amount of bytes between two
+     * lines, the row of the image at the first line, and the amount of lines.
+     */
+    using StripEditor = std::function<void(uchar *, std::ptrdiff_t, int, int)>;
+
+    /**
+     * @brief Quality used to encode the written file.
+     */
+    static constexpr int defaultQuality { 100 };
+
+    /**
+     * @brief Open a JPEG file and read its header.
+     * @param srcPath Path to the JPEG file, in the local 8-bit encoding.
+     * @throw std::runtime_error if the file could not be opened or is not a valid JPEG file.
+     * @throw std::domain_error if the file is stored in multiple scans, such as a progressive JPEG file.
+     */
+    explicit JPEGStripTranscoder(const std::string &srcPath);
+    JPEGStripTranscoder(const JPEGStripTranscoder &) = delete;
+    JPEGStripTranscoder(JPEGStripTranscoder &&) noexcept;
+    JPEGStripTranscoder &operator=(const JPEGStripTranscoder &) = delete;
+    JPEGStripTranscoder &operator=(JPEGStripTranscoder &&) noexcept;
+    ~JPEGStripTranscoder();
+
+    /**
+     * @brief Decode the whole file, edit every strip in order, and encode them into another file.
+     *
+     * Could be called only once. The written file is removed if anything fails, including @p edit.
+     *
+     * @param outPath Path of the file to write, in the local 8-bit encoding.
+     * @param edit Function which edit each strip, may throw to stop.
+     * @param quality Quality of the written file in [0, 100].
+     * @throw std::runtime_error if the file could not be written or libjpeg failed.
+     */
+    void transcode(const std::string &outPath, const StripEditor &edit,
+                   int quality = defaultQuality);
+
+public: // Accessors
+    /**
+     * @brief Width of the image.
+     */
+    int width() const;
+    /**
+     * @brief Height of the image.
+     */
+    int height() const;
+    /**
+     * @brief Amount of rows of a strip.
+     */
+    int stripHeight() const;
+
+private:
+    /**
+     * @brief libjpeg state, kept out of the header.
+     */
+    struct State;
+
+private:
+    /**
+     * @brief libjpeg state of the file read.
+     */
+    std::unique_ptr<State> state_;
+};
+}
@@ -0,0 +1,106 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <fmt/format.h>
+
+#include "utils/PerceptualHash.hpp"
+
+namespace utils {
+PerceptualHash::PerceptualHash(std::uint64_t bits) : bits_ { bits } { }
+
+PerceptualHash PerceptualHash::fromImage(const QImage &image)
+{
+    return fromThumbnail(ImageThumbnail::fromImage(image));
+}
+
+PerceptualHash PerceptualHash::fromFile(const QString &path)
+{
+    return fromThumbnail(ImageThumbnail::fromFile(path));
+}
+
+PerceptualHash PerceptualHash::fromHex(std::string_view hex)
+{
+    while (!hex.empty() && std::isspace(static_cast<unsigned char>(hex.front())))
+        hex.remove_prefix(1);
+    while (!hex.empty() && std::isspace(static_cast<unsigned char>(hex.back())))
+        hex.remove_suffix(1);
+
+    if (hex.empty() || hex.size() > hashSize * hashSize / 4
+        || !std::all_of(hex.begin(), hex.end(),
+                        [](char elm) { return std::isxdigit(static_cast<unsigned char>(elm)); }))
+        throw std::invalid_argument { "Parameter hex is not a perceptual hash." };
+
+    return PerceptualHash { std::stoull(std::string { hex }, nullptr, 16) };
+}
+
+std::string PerceptualHash::toHex() const
+{
+    return fmt::format("{:016X}", bits_);
+}
+
+int PerceptualHash::distance(const PerceptualHash &rhs) const
+{
+    return static_cast<int>(std::bitset<64> { bits_ ^ rhs.bits_ }.count());
+}
+
+std::uint64_t PerceptualHash::bits() const
+{
+    return bits_;
+}
+
+PerceptualHash PerceptualHash::fromThumbnail(const ImageThumbnail &thumbnail)
+{
+    const auto &resized = thumbnail.samples();
+
+    // Unnormalized DCT-II of both axes as scipy.fftpack.dct, only the hashed block is computed.
+    static const auto basis = [] {
+        std::array<double, hashSize * imageSize> result;
+        for (int k = 0; k < hashSize; k++) {
+            for (int n = 0; n < imageSize; n++) {
+                result[k * imageSize + n] = 2.0
+                        * std::cos(boost::math::double_constants::pi * k * (2 * n + 1)
+                                   / (2 * imageSize));
+            }
+        }
+        return result;
+    }();
+
+    std::array<double, hashSize * imageSize> columns {};
+    for (int k = 0; k < hashSize; k++) {
+        for (int y = 0; y < imageSize; y++) {
+            for (int x = 0; x < imageSize; x++)
+                columns[k * imageSize + x] += basis[k * imageSize + y] * resized[y * imageSize + x];
+        }
+    }
+
+    std::array<double, hashSize * hashSize> block {};
+    for (int k = 0; k < hashSize; k++) {
+        for (int l = 0; l < hashSize; l++) {
+            for (int x = 0; x < imageSize; x++)
+                block[k * hashSize + l] += basis[l * imageSize + x] * columns[k * imageSize + x];
+        }
+    }
+
+    auto sorted = block;
+    constexpr std::size_t middle { hashSize * hashSize / 2 };
+    std::nth_element(sorted.begin(), sorted.begin() + middle, sorted.end());
+    const double upper { sorted[middle] };
+    const double lower { *std::max_element(sorted.begin(), sorted.begin() + middle) };
+    const double median { (lower + upper) / 2 };
+
+    std::uint64_t bits { 0 };
+    for (auto coefficient : block) bits = (bits << 1) | (coefficient > median ? 1 : 0);
+    return PerceptualHash { bits };
+}
+}
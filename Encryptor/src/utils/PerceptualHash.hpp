@@ -0,0 +1,107 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QImage>
+#include <QString>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "utils/ImageThumbnail.hpp"
+
+namespace utils {
+/**
+ * @brief Perceptual hash of an image, bit compatible with imagehash.phash for decoded images.
+ *
+ * The image is reduced to an ImageThumbnail, which has the size imagehash resizes to, then transformed by
+ * an unnormalized DCT-II on both axes. Each coefficient of the top-left hashSize x hashSize block is set if
+ * it is greater than the median of the block. Bits are in row major order from the most significant one,
+ * so toHex() prints the same string as str(imagehash.phash(image)).upper(). Images whose coefficients tie
+ * with the median, such as flat images, may differ from SciPy in the rounding of the transform.
+ */
+class PerceptualHash
+{
+public:
+    /**
+     * @brief Width and height of the block of coefficients hashed.
+     */
+    static constexpr int hashSize { 8 };
+    /**
+     * @brief Ratio of the resized image to the hashed block.
+     */
+    static constexpr int highFreqFactor { 4 };
+    /**
+     * @brief Width and height of the resized image.
+     */
+    static constexpr int imageSize { hashSize * highFreqFactor };
+    static_assert(imageSize == ImageThumbnail::size, "Thumbnail size must match the transform.");
+
+public:
+    /**
+     * @brief Create hash from its bits.
+     * @param bits Bits of the hash, first coefficient in the most significant bit.
+     */
+    explicit PerceptualHash(std::uint64_t bits = 0);
+
+    /**
+     * @brief Hash an image.
+     * @param image Image to hash, must not be null.
+     * @return Hash of the image.
+     * @throw std::invalid_argument if @p image is null.
+     */
+    static PerceptualHash fromImage(const QImage &image);
+    /**
+     * @brief Hash an image file.
+     *
+     * The file is reduced by ImageThumbnail::fromFile(const QString &). JPEG files twice as large as
+     * ImageThumbnail::minDecodeSize are decoded scaled down, so their hash may differ from imagehash by a
+     * few bits.
+     *
+     * @param path Path to the image.
+     * @return Hash of the image.
+     * @throw std::runtime_error if the file could not be read or is not a valid image.
+     */
+    static PerceptualHash fromFile(const QString &path);
+    /**
+     * @brief Hash the thumbnail of an image.
+     * @param thumbnail Thumbnail of the image.
+     * @return Hash of the image.
+     */
+    static PerceptualHash fromThumbnail(const ImageThumbnail &thumbnail);
+    /**
+     * @brief Parse hash printed by toHex().
+     * @param hex Hash in hex, case insensitive, surrounding whitespaces are ignored.
+     * @return Parsed hash.
+     * @throw std::invalid_argument if @p hex is not a hash.
+     */
+    static PerceptualHash fromHex(std::string_view hex);
+
+    /**
+     * @brief Print hash in upper case hex.
+     * @return Hash in hex, hashSize * hashSize / 4 digits.
+     */
+    std::string toHex() const;
+    /**
+     * @brief Get amount of bits which differ between two hashes.
+     * @param rhs Hash to compare with.
+     * @return Hamming distance between the hashes, in [0, 64].
+     */
+    int distance(const PerceptualHash &rhs) const;
+
+public: // Accessors
+    /**
+     * @brief Get bits of the hash.
+     */
+    std::uint64_t bits() const;
+
+private:
+    /**
+     * @brief Bits of the hash.
+     */
+    std::uint64_t bits_;
+};
+}
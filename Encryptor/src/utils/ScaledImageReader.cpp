@@ -0,0 +1,99 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QDebug>
+#include <QFile>
+#include <QImageReader>
+
+#include <cstdio>
+#include <string>
+
+#include <boost/scope_exit.hpp>
+
+#include "utils/JPEGSupport.hpp"
+#include "utils/ScaledImageReader.hpp"
+
+namespace utils {
+namespace {
+/**
+ * @brief Decode a JPEG file scaled down by libjpeg.
+ * @param path Path to the file, in the local 8-bit encoding.
+ * @param szMin Smallest size of the decoded image.
+ * @return Decoded image, null if the file is not a JPEG file of luminance or color.
+ */
+QImage decodeJPEG(const std::string &path, const QSize &szMin)
+{
+    // Every object is built before setjmp, so a jump from libjpeg never skip a destructor.
+    std::FILE *file { std::fopen(path.c_str(), "rb") };
+    if (file == nullptr) return {};
+
+    QImage image;
+    JPEGErrorManager error;
+    jpeg_decompress_struct decompress;
+    decompress.err = error.install();
+    jpeg_create_decompress(&decompress);
+    BOOST_SCOPE_EXIT_ALL(&)
+    {
+        jpeg_destroy_decompress(&decompress);
+        std::fclose(file);
+    };
+
+    if (setjmp(error.jump)) {
+        qDebug() << "Unable to read JPEG:" << error.message;
+        return {};
+    }
+
+    jpeg_stdio_src(&decompress, file);
+    jpeg_read_header(&decompress, TRUE);
+    if (decompress.jpeg_color_space != JCS_GRAYSCALE && decompress.num_components != 3) return {};
+
+    const QSize szImage { static_cast<int>(decompress.image_width),
+                          static_cast<int>(decompress.image_height) };
+    decompress.scale_num = 1;
+    decompress.scale_denom =
+            static_cast<unsigned int>(ScaledImageReader::scaleDenominator(szImage, szMin));
+    decompress.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&decompress);
+
+    image = QImage { static_cast<int>(decompress.output_width),
+                     static_cast<int>(decompress.output_height), QImage::Format_RGB888 };
+    if (image.isNull()) return {};
+
+    while (decompress.output_scanline < decompress.output_height) {
+        JSAMPROW row { image.scanLine(static_cast<int>(decompress.output_scanline)) };
+        jpeg_read_scanlines(&decompress, &row, 1);
+    }
+    jpeg_finish_decompress(&decompress);
+
+    // QImageReader decodes JPEG files into RGB32 as well.
+    return image.convertToFormat(QImage::Format_RGB32);
+}
+}
+
+int ScaledImageReader::scaleDenominator(const QSize &szImage, const QSize &szMin)
+{
+    // libjpeg rounds scaled sizes up.
+    for (int denominator = maxDenominator; denominator > 1; denominator /= 2) {
+        if ((szImage.width() + denominator - 1) / denominator >= szMin.width()
+            && (szImage.height() + denominator - 1) / denominator >= szMin.height())
+            return denominator;
+    }
+    return 1;
+}
+
+QImage ScaledImageReader::read(const QString &path, const QSize &szMin)
+{
+    QImageReader reader { path };
+    if (reader.format() == "jpeg") {
+        auto image = decodeJPEG(QFile::encodeName(path).toStdString(), szMin);
+        if (!image.isNull()) return image;
+    }
+
+    const auto szImage = reader.size();
+    if (szImage.isValid() && szImage.width() > szMin.width() && szImage.height() > szMin.height())
+        reader.setScaledSize(szImage.scaled(szMin, Qt::KeepAspectRatioByExpanding));
+    return reader.read();
+}
+}
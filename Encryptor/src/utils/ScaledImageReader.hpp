@@ -0,0 +1,47 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+namespace utils {
+/**
+ * @brief Read images at a reduced resolution, for previews and hashes which never need every pixel.
+ *
+ * JPEG files are decoded by libjpeg at 1/2, 1/4 or 1/8 of their size, which skips most of the inverse DCT
+ * and color conversion instead of decoding every pixel and scaling them down afterwards.
+ */
+class ScaledImageReader
+{
+public:
+    /**
+     * @brief Largest denominator libjpeg could scale an image by.
+     */
+    static constexpr int maxDenominator { 8 };
+
+public:
+    /**
+     * @brief Get the largest denominator, among 1, 2, 4 and 8, which keeps an image at least a size.
+     * @param szImage Size of the image.
+     * @param szMin Smallest size of the scaled image.
+     * @return Denominator to set as scale_denom, with scale_num set to 1.
+     */
+    static int scaleDenominator(const QSize &szImage, const QSize &szMin);
+
+    /**
+     * @brief Read an image file, scaled down as long as it stays at least a size.
+     *
+     * The aspect ratio is kept, so the image may be larger than @p szMin on one axis. Images which are
+     * already smaller are read at their size.
+     *
+     * @param path Path to the image.
+     * @param szMin Smallest size of the read image.
+     * @return Read image, null if the file could not be read.
+     */
+    static QImage read(const QString &path, const QSize &szMin);
+};
+}
@@ -0,0 +1,237 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QFile>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "utils/HammingSearch.hpp"
+
+namespace utils {
+/**
+ * @brief Singleton object that indexes the perceptual hashes of signed images to find near-duplicates.
+ *
+ * Hashes are split into substringCount substrings, and a table per substring lists the entries by the value
+ * of that substring. Two hashes within a radius r share at least one substring within r / substringCount,
+ * so a query only probes the values close to its own substrings, then verifies the candidates by their full
+ * distance. When the radius makes probing slower than a scan, the stored hashes are scanned instead.
+ *
+ * Each hash is stored with the key which signed its image, a copy only counts as signed by a key if its
+ * nearest stored hash was signed by that very key, see isSignedBy(std::uint64_t, std::uint64_t).
+ *
+ * The file is memory-mapped when loaded, tables are read in place so loading does not depend on the size of
+ * the index. Inserted and removed entries are kept in memory until the index is saved, which rewrites the
+ * file. Every member may be called from any thread.
+ */
+class SimilarityIndex
+{
+public:
+    /**
+     * @brief Amount of substrings a hash is split into.
+     */
+    static constexpr int substringCount { 4 };
+    /**
+     * @brief Amount of bits of a substring.
+     */
+    static constexpr int substringBits { 64 / substringCount };
+    /**
+     * @brief Largest distance at which a hash is taken as a copy of a stored one.
+     *
+     * Two unrelated hashes are this close with a probability of about 3e-10, so even a large index
+     * does not mistake an unrelated image for a signed one.
+     */
+    static constexpr int matchRadius { 8 };
+
+    /**
+     * @brief Stored hash found close to a query.
+     */
+    struct Match
+    {
+        /**
+         * @brief Identifier given when the hash was inserted.
+         */
+        std::uint64_t id;
+        /**
+         * @brief Stored hash.
+         */
+        std::uint64_t hash;
+        /**
+         * @brief Signer given when the hash was inserted.
+         */
+        std::uint64_t signer;
+        /**
+         * @brief Amount of bits which differ from the query.
+         */
+        int distance;
+    };
+
+public:
+    SimilarityIndex(const SimilarityIndex &) = delete;
+    SimilarityIndex(SimilarityIndex &&) = delete;
+    SimilarityIndex &operator=(const SimilarityIndex &) = delete;
+    SimilarityIndex &operator=(SimilarityIndex &&) = delete;
+
+    /**
+     * @brief Get unique instance of SimilarityIndex.
+     * @return Unique instance of SimilarityIndex.
+     */
+    static SimilarityIndex &getInstance();
+
+    /**
+     * @brief Replace the index with the content of a file.
+     * @param path Path to the file, the index is saved into it.
+     * @return True if the file is loaded or does not exist yet, false if it is not a valid index, in which
+     * case the index is empty.
+     */
+    bool load(const QString &path);
+    /**
+     * @brief Write the index into the file loaded, including pending insertions and removals.
+     * @return True if the index is saved.
+     */
+    bool save();
+
+    /**
+     * @brief Get signer of a key, as stored with the hashes of the images it signed.
+     * @param fingerprint Fingerprint of the key, see codec::SignaturePayload::fingerprint.
+     * @return Leading 8 bytes of @p fingerprint.
+     * @throw std::invalid_argument if @p fingerprint is shorter than 8 bytes.
+     */
+    static std::uint64_t signerOf(std::string_view fingerprint);
+
+    /**
+     * @brief Add a hash to the index.
+     * @param hash Hash to add.
+     * @param id Identifier returned by the queries matching @p hash.
+     * @param signer Signer of the key which signed the image, see signerOf(std::string_view).
+     */
+    void insert(std::uint64_t hash, std::uint64_t id, std::uint64_t signer);
+    /**
+     * @brief Remove every hash inserted with an identifier.
+     * @param id Identifier of the hashes.
+     * @return Amount of hashes removed.
+     */
+    std::size_t remove(std::uint64_t id);
+    /**
+     * @brief Find stored hashes close to a hash.
+     * @param hash Hash to look up.
+     * @param radius Largest distance of a match.
+     * @return Matches within @p radius, closest first then by identifier.
+     */
+    std::vector<Match> query(std::uint64_t hash, int radius) const;
+    /**
+     * @brief Check if a hash is of a copy of an image signed by a key.
+     *
+     * Only the nearest stored hash within matchRadius is considered, a copy closer to an image of another
+     * signer is not taken as signed by @p signer.
+     * @param hash Hash to look up.
+     * @param signer Signer of the key, see signerOf(std::string_view).
+     * @return True if the nearest stored hash is within matchRadius and was signed by @p signer.
+     */
+    bool isSignedBy(std::uint64_t hash, std::uint64_t signer) const;
+
+public: // Accessors
+    /**
+     * @brief Get amount of hashes in the index.
+     */
+    std::size_t size() const;
+
+private:
+    SimilarityIndex() = default;
+
+    /**
+     * @brief Unmap the file and forget about its entries.
+     */
+    void unmap();
+    /**
+     * @brief Map the file loaded and check its layout.
+     * @return True if the file is mapped.
+     */
+    bool map();
+    /**
+     * @brief Determine if an entry of the file is removed.
+     * @param idx Index of the entry in the file.
+     */
+    bool isRemoved(std::size_t idx) const;
+    /**
+     * @brief Add matches among the entries of the file, by probing the substring tables.
+     */
+    void probe(std::uint64_t hash, int radius, std::vector<Match> &matches) const;
+    /**
+     * @brief Add matches among a contiguous array of hashes, by comparing each of them.
+     */
+    void scan(std::uint64_t hash, int radius, const std::uint64_t *hashes, const std::uint64_t *ids,
+              const std::uint64_t *signers, std::size_t count, bool mapped,
+              std::vector<Match> &matches) const;
+
+private:
+    /**
+     * @brief Guard of every member.
+     */
+    mutable std::mutex mutex_;
+    /**
+     * @brief Distance kernels.
+     */
+    HammingSearch search_;
+    /**
+     * @brief File of the index.
+     */
+    QFile file_;
+    /**
+     * @brief Mapped file, nullptr if no file is mapped.
+     */
+    uchar *mapped_ { nullptr };
+    /**
+     * @brief Amount of entries of the file.
+     */
+    std::size_t mappedCount_ { 0 };
+    /**
+     * @brief Hashes of the file.
+     */
+    const std::uint64_t *mappedHashes_ { nullptr };
+    /**
+     * @brief Identifiers of the file, in the order of mappedHashes_.
+     */
+    const std::uint64_t *mappedIds_ { nullptr };
+    /**
+     * @brief Signers of the file, in the order of mappedHashes_.
+     */
+    const std::uint64_t *mappedSigners_ { nullptr };
+    /**
+     * @brief First posting of each substring value, for each table of the file.
+     */
+    const std::uint32_t *offsets_[substringCount] {};
+    /**
+     * @brief Entries of the file sorted by substring value, for each table of the file.
+     */
+    const std::uint32_t *postings_[substringCount] {};
+    /**
+     * @brief Identifiers removed from the file.
+     */
+    std::unordered_set<std::uint64_t> removedIds_;
+    /**
+     * @brief Entries of the file which are removed.
+     */
+    std::size_t removedCount_ { 0 };
+    /**
+     * @brief Hashes inserted since the file was loaded.
+     */
+    std::vector<std::uint64_t> addedHashes_;
+    /**
+     * @brief Identifiers inserted since the file was loaded, in the order of addedHashes_.
+     */
+    std::vector<std::uint64_t> addedIds_;
+    /**
+     * @brief Signers inserted since the file was loaded, in the order of addedHashes_.
+     */
+    std::vector<std::uint64_t> addedSigners_;
+};
+}
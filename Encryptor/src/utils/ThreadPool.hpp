@@ -0,0 +1,158 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+/**
+ * @brief Singleton work-stealing thread pool shared by the whole application.
+ *
+ * Every worker owns a task queue, it pops the newest task of its own queue and steals the oldest task
+ * of the other queues once its own queue is empty. Tasks submitted from a worker stay on that worker,
+ * tasks submitted from other threads are spread across the queues in round robin. The thread which
+ * wait for the tasks works on them as well, so a pool of N threads only starts N - 1 workers.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Unit of work executed by the pool.
+     */
+    using Task = std::function<void()>;
+
+public:
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ThreadPool &operator=(ThreadPool &&) = delete;
+    ~ThreadPool();
+
+    /**
+     * @brief Get unique instance of ThreadPool.
+     * @return Unique instance of ThreadPool.
+     */
+    static ThreadPool &getInstance();
+
+    /**
+     * @brief Run @p body for every index in [0, @p count) and wait until all of them finished.
+     *
+     * Indices are scheduled as separate tasks, the calling thread executes queued tasks while waiting,
+     * so it is safe to call from a worker of the pool.
+     *
+     * @param count Amount of indices.
+     * @param body Function to run with each index.
+     * @throw Rethrow the first exception thrown by @p body, after every index finished.
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)> &body);
+
+public: // Accessors
+    /**
+     * @brief Get amount of threads which work on a parallel loop, including the calling thread.
+     */
+    std::size_t threadCount() const;
+
+public: // Mutators
+    /**
+     * @brief Restart the pool with a new amount of threads.
+     *
+     * Queued tasks are finished before the current workers stopped. Must not be called while a
+     * parallelFor(std::size_t, const std::function<void(std::size_t)> &) is in progress. With a single
+     * thread no worker is started and every task runs on the calling thread.
+     *
+     * @param count Amount of threads including the calling thread, 0 to use the amount of hardware
+     * threads.
+     */
+    void setThreadCount(std::size_t count);
+
+private:
+    /**
+     * @brief Task queue owned by a worker.
+     */
+    struct WorkQueue
+    {
+        /**
+         * @brief Lock of @p tasks.
+         */
+        std::mutex mutex;
+        /**
+         * @brief Queued tasks, the owner works on the back and thieves on the front.
+         */
+        std::deque<Task> tasks;
+    };
+
+private:
+    /**
+     * @brief Start pool with a thread per hardware thread, internal use only.
+     */
+    ThreadPool();
+
+    /**
+     * @brief Start @p count - 1 workers.
+     * @param count Amount of threads including the calling thread, 0 to use the amount of hardware
+     * threads.
+     */
+    void start(std::size_t count);
+    /**
+     * @brief Finish queued tasks and join every worker.
+     */
+    void stop();
+    /**
+     * @brief Queue a task, or run it right away if the pool has no worker.
+     * @param task Task to queue.
+     */
+    void push(Task task);
+    /**
+     * @brief Take a task, from the queue of @p self first then from the other queues.
+     * @param self Index of the queue owned by the calling thread, or queue count if it owns none.
+     * @param task Task taken.
+     * @return True if a task was taken.
+     */
+    bool tryPop(std::size_t self, Task &task);
+    /**
+     * @brief Main loop of a worker.
+     * @param self Index of the queue owned by the worker.
+     */
+    void run(std::size_t self);
+
+private:
+    /**
+     * @brief Task queue of every worker.
+     */
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    /**
+     * @brief Worker threads.
+     */
+    std::vector<std::thread> workers_;
+    /**
+     * @brief Amount of tasks waiting in the queues.
+     */
+    std::atomic<std::size_t> queued_ { 0 };
+    /**
+     * @brief Queue which receive the next task submitted from outside of the pool.
+     */
+    std::atomic<std::size_t> nextQueue_ { 0 };
+    /**
+     * @brief Lock of @p wakeUp_ and @p stopping_.
+     */
+    std::mutex wakeMutex_;
+    /**
+     * @brief Signaled when a task is queued or the pool is stopping.
+     */
+    std::condition_variable wakeUp_;
+    /**
+     * @brief Determine if workers should exit once the queues are empty.
+     */
+    bool stopping_ { false };
+};
+}
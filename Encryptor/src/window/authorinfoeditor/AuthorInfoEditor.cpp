@@ -49,6 +49,11 @@ AuthorInfoEditor::getSelectedKey()
     return std::make_pair(std::move(*author), std::move(confirmedKey_));
 }
 
+std::uint32_t AuthorInfoEditor::getSelectedKeyID() const
+{
+    return confirmedKeyID_;
+}
+
 void AuthorInfoEditor::onBtnCancelClicked()
 {
     this->close();
@@ -258,6 +263,7 @@ void AuthorInfoEditor::onConfirmKey()
     auto &decryptedKey = symCodec->getCodecResult();
     confirmedKey_ = facKey->deserializeKeyParams(
             { reinterpret_cast<const char *>(decryptedKey.data()), decryptedKey.size() });
+    confirmedKeyID_ = key->keyID;
     confirmed_ = true;
     this->close();
 }
@@ -33,6 +33,11 @@ public:
      */
     std::optional<std::pair<db::data::Author, std::unique_ptr<CryptoPP::RandomizedTrapdoorFunctionInverse>>>
     getSelectedKey();
+    /**
+     * @brief Get ID of the selected key.
+     * @return ID of the key confirmed by the user, referenced as db::data::KeyStore.
+     */
+    std::uint32_t getSelectedKeyID() const;
 
 private slots:
     /**
@@ -130,5 +135,9 @@ private:
      * @brief Key confirmed by the user.
      */
     std::unique_ptr<CryptoPP::RandomizedTrapdoorFunctionInverse> confirmedKey_;
+    /**
+     * @brief ID of the key confirmed by the user.
+     */
+    std::uint32_t confirmedKeyID_ { -1u };
 };
 }
\ No newline at end of file
@@ -4,27 +4,23 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  *********************************************************************************************************************/
 #include <QApplication>
-#include <QDateTime>
 #include <QDebug>
 #include <QFileDialog>
-#include <QFileInfo>
 #include <QGuiApplication>
 #include <QMessageBox>
 #include <QPixmap>
 #include <QScreen>
+#include <QStatusBar>
 
-#include <fstream>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
-#include <boost/process.hpp>
-#include <boost/process/windows.hpp>
-#include <boost/scope_exit.hpp>
-
 #include <fmt/format.h>
 
 #include "window/mainwindow/MainWindow.hpp"
 #include "codec/DefaultCodecFactory.hpp"
+#include "components/ImagePreview.hpp"
 #include "db/DBManager.hpp"
 #include "generator/DefaultCryptoKeyGeneratorFactory.hpp"
 #include "generator/PrivateRSACryptoKeyGenerator.hpp"
@@ -37,21 +33,18 @@ namespace window {
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui_ { std::make_unique<Ui::MainWindow>() }
 {
+    signingPool_.setMaxThreadCount(1);
     ui_->setupUi(this);
     initUI();
     loadStylesheet();
     auto *storage = &db::DBManager::getInstance();
     storage->initDB();
+}
 
-#ifdef DEBUG
-    std::fstream test;
-    test.open("./perceptual_hash.exe", std::ios::in);
-    if (test.is_open()) {
-        qDebug() << "Found hash executable";
-        test.close();
-    }
-    if (QFileInfo::exists(QStringLiteral("./jsteg.exe"))) qDebug() << "Found jsteg executable";
-#endif // DEBUG
+MainWindow::~MainWindow()
+{
+    onBtnCancelSigning();
+    signingPool_.waitForDone();
 }
 
 void MainWindow::onBtnLoadImgClicked()
@@ -60,7 +53,9 @@ void MainWindow::onBtnLoadImgClicked()
                                                 { SelectImageFormatFilter.data() });
     oriImagePath_ = imgPath;
     if (imgPath.isEmpty()) return;
-    targetImage_.load(imgPath);
+
+    // Only the file is signed, the image is read at the resolution of its preview.
+    targetImage_ = components::ImagePreview::load(imgPath);
     ui_->labImagePreview->setImage(&targetImage_);
 }
 
@@ -79,6 +74,7 @@ void MainWindow::onBtnLoadKeyClicked()
 
     auto &[author, key] = *result;
     this->author_ = std::move(author);
+    keyID_ = dialog->getSelectedKeyID();
     std::unique_ptr<key_generator::ICryptoKeyGeneratorFactory> facKey {
         std::make_unique<key_generator::DefaultCryptoKeyGeneratorFactory>()
     };
@@ -129,8 +125,6 @@ void MainWindow::onBtnLoadKeyClicked()
 
 void MainWindow::onBtnSignAndExport()
 {
-    namespace bp = boost::process;
-
     if (targetImage_.isNull()) {
         QMessageBox::information(this, "No image selected", "Select an image first to sign");
         return;
@@ -145,75 +139,37 @@ void MainWindow::onBtnSignAndExport()
     if (outPath.isEmpty()) return;
     qDebug() << outPath;
 
-    auto result = QMessageBox::warning(this, "Operation will take very long time!",
-                                       "This operation will take minutes to complete according to "
-                                       "the size of the image, are you sure to continue?",
-                                       QMessageBox::Button::Yes | QMessageBox::Button::No);
-
-    if (result != QMessageBox::Button::Yes) return;
-
-    auto prevWindowTitle = this->windowTitle();
-    QApplication::setOverrideCursor(Qt::CursorShape::WaitCursor);
-
-    BOOST_SCOPE_EXIT_ALL(&, this)
-    {
-        this->setWindowTitle(prevWindowTitle);
-        QApplication::restoreOverrideCursor();
-    };
-
-    const auto titleTemplate = fmt::format("{} - {{}}", prevWindowTitle.toStdString());
-
-    std::unique_ptr<codec::ICodecFactory> facCodec {
-        std::make_unique<codec::DefaultCodecFactory>()
+    // Signals of the job are emitted from the signing thread, connections to this window are queued.
+    auto job = new SigningJob {
+        oriImagePath_, outPath, targetImage_, pbKey_, prKey_, author_, keyID_, this
     };
+    connect(job, &SigningJob::progressUpdated, this, [this, job](float progress) {
+        if (!signingJobs_.empty() && signingJobs_.front() == job)
+            ui_->progSigning->setValue(static_cast<int>(progress));
+    });
+    connect(job, &SigningJob::completed, this, [this, job] {
+        job->recordSignedImage();
+        statusBar()->showMessage(QString { "Signed image saved to %1" }.arg(job->outPath()));
+        finishSigningJob(job);
+    });
+    connect(job, &SigningJob::failed, this, [this, job](const QString &reason) {
+        finishSigningJob(job);
+        QMessageBox::information(this, "Unable to sign", reason);
+    });
+    connect(job, &SigningJob::cancelled, this, [this, job] {
+        statusBar()->showMessage(QString { "Signing of %1 cancelled" }.arg(job->outPath()));
+        finishSigningJob(job);
+    });
+
+    signingJobs_.push_back(job);
+    job->start(signingPool_);
+    updateSigningStatus();
+}
 
-    auto signer =
-            facCodec->createDefaultImageSigner(targetImage_, pbKey_.get(), prKey_.get(), &author_);
-    signer->execute();
-    this->setWindowTitle(QString::fromStdString(fmt::format(titleTemplate, "Generating receipt")));
-    auto signingReceipt = signer->getSigningReceipt();
-
-    std::ofstream fileSigningReceipt;
-    fileSigningReceipt.open(fmt::format("{}.sign", outPath.toStdString()));
-    if (!fileSigningReceipt.is_open()) return;
-
-    auto time = QDateTime::currentDateTimeUtc();
-    std::string iso8601 { fmt::format(
-            "{}-{}-{}T{}:{}:{}Z", time.date().year(), time.date().month(), time.date().day(),
-            time.time().hour(), time.time().minute(), time.time().second()) };
-    fileSigningReceipt << iso8601 << std::endl;
-    fileSigningReceipt << signingReceipt << std::endl;
-
-    bp::ipstream outHasher;
-    std::string argsHasher =
-            fmt::format("./perceptual_hash.exe --hash \"{}\"", oriImagePath_.toStdString());
-
-#if defined(WIN32) && !defined(DEBUG)
-    bp::child hasher { argsHasher, bp::std_out > outHasher, bp::windows::create_no_window };
-#else
-    bp::child hasher { argsHasher, bp::std_out > outHasher };
-#endif // defined(WIN32) && !defined(DEBUG)
-
-    hasher.wait();
-    std::string pHash;
-    std::getline(outHasher, pHash);
-    qDebug() << QString::fromStdString(pHash);
-    fileSigningReceipt << pHash;
-    fileSigningReceipt.close();
-
-    this->setWindowTitle(QString::fromStdString(fmt::format(titleTemplate, "Signing...")));
-    auto argsImgSigner =
-            fmt::format("jsteg.exe hide \"{}\" \"{}.sign\" \"{}\"", oriImagePath_.toStdString(),
-                        outPath.toStdString(), outPath.toStdString());
-#if defined(WIN32) && !defined(DEBUG)
-    bp::child imgSigner { argsImgSigner, bp::windows::create_no_window };
-#else
-    bp::child imgSigner { argsImgSigner };
-#endif // defined(WIN32) && !defined(DEBUG)
-
-    imgSigner.wait();
-
-    qDebug() << QString::fromStdString(signingReceipt);
+void MainWindow::onBtnCancelSigning()
+{
+    for (auto job : signingJobs_)
+        job->cancel();
 }
 
 void MainWindow::loadStylesheet()
@@ -230,5 +186,23 @@ void MainWindow::initUI()
     ui_->splitSidebar->setStretchFactor(ui_->splitSidebar->indexOf(ui_->clientAreaPanel), 1);
     ui_->sidebarPanel->resize(ui_->sidebarPanel->maximumWidth(), ui_->sidebarPanel->height());
     ui_->sidebarPanel->setMaximumWidth(maxSize);
+    updateSigningStatus();
+}
+
+void MainWindow::finishSigningJob(SigningJob *job)
+{
+    signingJobs_.erase(std::find(signingJobs_.begin(), signingJobs_.end(), job));
+    job->deleteLater();
+    ui_->progSigning->setValue(0);
+    updateSigningStatus();
+}
+
+void MainWindow::updateSigningStatus()
+{
+    const bool isSigning { !signingJobs_.empty() };
+    ui_->progSigning->setVisible(isSigning);
+    ui_->btnCancelSigning->setEnabled(isSigning);
+    ui_->labSigningQueue->setText(
+            isSigning ? QString { "%1 image(s) to sign" }.arg(signingJobs_.size()) : QString {});
 }
 }
\ No newline at end of file
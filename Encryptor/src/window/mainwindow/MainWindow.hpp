@@ -6,13 +6,16 @@
 #pragma once
 #include <QImage>
 #include <QMainWindow>
+#include <QThreadPool>
 
+#include <deque>
 #include <memory>
 #include <string_view>
 
 #include "ui_MainWindow.h"
 #include "generator/ICryptoKeyGenerator.hpp"
 #include "db/data/Author.hpp"
+#include "window/mainwindow/SigningJob.hpp"
 
 namespace window {
 /**
@@ -30,6 +33,10 @@ public:
      * @param parent Parent of the window, nullptr for no parent.
      */
     explicit MainWindow(QWidget *parent = nullptr);
+    /**
+     * @brief Cancel every signing job and wait for the running one to stop.
+     */
+    ~MainWindow() override;
 
 private slots:
     /**
@@ -48,6 +55,10 @@ private slots:
      * @brief Triggered when sign image button is clicked.
      */
     void onBtnSignAndExport();
+    /**
+     * @brief Triggered when cancel signing button is clicked.
+     */
+    void onBtnCancelSigning();
 
 private:
     /**
@@ -58,6 +69,15 @@ private:
      * @brief Extra steps to initialize the UI.
      */
     void initUI();
+    /**
+     * @brief Remove a signing job which is done from the queue.
+     * @param job Job to remove, deleted later.
+     */
+    void finishSigningJob(SigningJob *job);
+    /**
+     * @brief Show progress and size of the signing queue.
+     */
+    void updateSigningStatus();
 
 private:
     /**
@@ -65,7 +85,7 @@ private:
      */
     std::unique_ptr<Ui::MainWindow> ui_;
     /**
-     * @brief Image to sign.
+     * @brief Image to sign, read at the resolution of its preview since the signing job reads the file.
      */
     QImage targetImage_;
     /**
@@ -75,14 +95,26 @@ private:
     /**
      * @brief Selected author's public key.
      */
-    std::unique_ptr<key_generator::ICryptoKeyGenerator> pbKey_;
+    std::shared_ptr<key_generator::ICryptoKeyGenerator> pbKey_;
     /**
      * @brief Selected author's private key.
      */
-    std::unique_ptr<key_generator::ICryptoKeyGenerator> prKey_;
+    std::shared_ptr<key_generator::ICryptoKeyGenerator> prKey_;
     /**
      * @brief Author information to sign.
      */
     db::data::Author author_;
+    /**
+     * @brief ID of the selected key, referenced as db::data::KeyStore.
+     */
+    std::uint32_t keyID_ { -1u };
+    /**
+     * @brief Pool of a single thread, so signing jobs run one after another in the order they are queued.
+     */
+    QThreadPool signingPool_;
+    /**
+     * @brief Signing jobs not done yet in queued order, the first one is running.
+     */
+    std::deque<SigningJob *> signingJobs_;
 };
 }
\ No newline at end of file
@@ -0,0 +1,314 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/scope_exit.hpp>
+#include <cryptopp/filters.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/sha.h>
+
+#include <fmt/format.h>
+
+#include "window/mainwindow/SigningJob.hpp"
+#include "codec/DefaultCodecFactory.hpp"
+#include "codec/SignaturePayload.hpp"
+#include "db/DBManager.hpp"
+#include "generator/PublicRSACryptoKeyGenerator.hpp"
+#include "utils/ConfigManager.hpp"
+#include "utils/HashCache.hpp"
+#include "utils/PerceptualHash.hpp"
+#include "utils/SimilarityIndex.hpp"
+
+namespace window {
+namespace {
+/**
+ * @brief Compute digest of the content of a file.
+ * @param path Path to the file.
+ * @return Hex encoded SHA-256 digest, empty if the file could not be read.
+ */
+std::string digestOf(const QString &path)
+{
+    QFile file { path };
+    if (!file.open(QIODevice::ReadOnly)) return {};
+
+    CryptoPP::SHA256 sha;
+    std::array<char, 1 << 16> buffer;
+    for (qint64 szRead; (szRead = file.read(buffer.data(), buffer.size())) > 0;)
+        sha.Update(reinterpret_cast<const CryptoPP::byte *>(buffer.data()),
+                   static_cast<std::size_t>(szRead));
+    std::array<CryptoPP::byte, CryptoPP::SHA256::DIGESTSIZE> digest;
+    sha.Final(digest.data());
+
+    std::string hexDigest;
+    CryptoPP::StringSource encoder {
+        digest.data(), digest.size(), true,
+        new CryptoPP::HexEncoder { new CryptoPP::StringSink { hexDigest } }
+    };
+    return hexDigest;
+}
+
+/**
+ * @brief Compute signer of a public key, as stored in utils::SimilarityIndex.
+ * @param pbKey Public key, a key_generator::PublicRSACryptoKeyGenerator.
+ * @return Signer of the short fingerprint of @p pbKey.
+ */
+std::uint64_t signerOf(const key_generator::ICryptoKeyGenerator &pbKey)
+{
+    const auto publicKey =
+            dynamic_cast<const key_generator::PublicRSACryptoKeyGenerator &>(pbKey).getPublicKey();
+    std::string dmpPbKey;
+    CryptoPP::StringSink pbKeySerializer { dmpPbKey };
+    publicKey.DEREncode(pbKeySerializer);
+    return utils::SimilarityIndex::signerOf(codec::SignaturePayload::fingerprint(
+            dmpPbKey, codec::SignaturePayload::shortFingerprintSize));
+}
+}
+
+SigningJob::SigningJob(QString srcPath, QString outPath, QImage image,
+                       std::shared_ptr<const key_generator::ICryptoKeyGenerator> pbKey,
+                       std::shared_ptr<const key_generator::ICryptoKeyGenerator> prKey,
+                       db::data::Author author, std::uint32_t keyID, QObject *parent)
+    : QObject { parent },
+      srcPath_ { std::move(srcPath) },
+      outPath_ { std::move(outPath) },
+      image_ { std::move(image) },
+      pbKey_ { std::move(pbKey) },
+      prKey_ { std::move(prKey) },
+      author_ { std::move(author) },
+      keyID_ { keyID },
+      fingerprintSize_ {
+          static_cast<std::size_t>(utils::ConfigManager::getInstance().getKeyFingerprintSize())
+      }
+{
+    if (pbKey_ == nullptr)
+        throw std::invalid_argument { "Parameter pbKey must not be nullptr but it seems to be." };
+
+    if (prKey_ == nullptr)
+        throw std::invalid_argument { "Parameter prKey must not be nullptr but it seems to be." };
+}
+
+QFuture<void> SigningJob::start(QThreadPool &pool)
+{
+    return QtConcurrent::run(&pool, [this] { run(); });
+}
+
+void SigningJob::cancel()
+{
+    cancelled_ = true;
+
+    std::lock_guard<std::mutex> lock { mutexSigner_ };
+    if (signer_ != nullptr) signer_->cancel();
+}
+
+bool SigningJob::isLargeImage(const QString &path)
+{
+    const auto size = QImageReader { path }.size();
+    return static_cast<qint64>(size.width()) * size.height() > largeImagePixels;
+}
+
+const QString &SigningJob::outPath() const
+{
+    return outPath_;
+}
+
+void SigningJob::run()
+{
+    // Signals are emitted after every local of sign(QString &) is gone, the window may delete the job
+    // as soon as it receives them.
+    QString reason;
+    switch (sign(reason)) {
+    case Result::Completed:
+        emit completed();
+        break;
+    case Result::Failed:
+        emit failed(reason);
+        break;
+    case Result::Cancelled:
+        emit cancelled();
+        break;
+    }
+}
+
+SigningJob::Result SigningJob::sign(QString &reason)
+{
+    if (cancelled_) return Result::Cancelled;
+
+    const bool isStreamed { isLargeImage(srcPath_) };
+    QByteArray srcImage;
+    if (!isStreamed) {
+        QFile fileSrc { srcPath_ };
+        if (!fileSrc.open(QIODevice::ReadOnly)) {
+            reason = "Unable to read the selected image.";
+            return Result::Failed;
+        }
+        srcImage = fileSrc.readAll();
+        fileSrc.close();
+    }
+
+    std::unique_ptr<codec::ICodecFactory> facCodec {
+        std::make_unique<codec::DefaultCodecFactory>()
+    };
+    auto signer = facCodec->createDefaultImageSigner(image_, pbKey_.get(), prKey_.get(), &author_);
+    signer->setFingerprintSize(fingerprintSize_);
+    if (isStreamed) {
+        // Coefficients of a large image do not fit in memory, sign it strip by strip from file to file.
+        signer->setStreamPaths(QFile::encodeName(srcPath_).toStdString(),
+                               QFile::encodeName(outPath_).toStdString());
+    } else {
+        // Sign the quantized coefficients of the file, so the image is never decoded nor re-encoded.
+        signer->setCodecData(reinterpret_cast<const std::byte *>(srcImage.constData()),
+                             static_cast<std::size_t>(srcImage.size()));
+    }
+    connect(signer.get(), &codec::ImageSignCodec::progressUpdated, this,
+            &SigningJob::onSignerProgress, Qt::DirectConnection);
+
+    {
+        std::lock_guard<std::mutex> lock { mutexSigner_ };
+        signer_ = signer.get();
+    }
+    BOOST_SCOPE_EXIT_ALL(&, this)
+    {
+        std::lock_guard<std::mutex> lock { mutexSigner_ };
+        signer_ = nullptr;
+    };
+
+    try {
+        // Cancel may have been requested before the signer is published.
+        if (cancelled_) signer->cancel();
+        signer->execute();
+    } catch (const std::length_error &e) {
+        qDebug() << e.what();
+        reason = "The image is not large enough to hold the signature.";
+        return Result::Failed;
+    } catch (const std::domain_error &e) {
+        qDebug() << e.what();
+        reason = "A progressive JPEG this large could not be signed, save it as a baseline JPEG.";
+        return Result::Failed;
+    } catch (const std::runtime_error &e) {
+        qDebug() << e.what();
+        if (cancelled_) return Result::Cancelled;
+
+        reason = isStreamed ? "Unable to sign the selected image into the selected file."
+                            : "The selected image is not a valid JPEG.";
+        return Result::Failed;
+    }
+
+    if (!isStreamed) {
+        if (cancelled_) return Result::Cancelled;
+
+        const auto &signedImage = signer->getCodecResult();
+        QFile fileSignedImage { outPath_ };
+        if (!fileSignedImage.open(QIODevice::WriteOnly)
+            || fileSignedImage.write(reinterpret_cast<const char *>(signedImage.data()),
+                                     static_cast<qint64>(signedImage.size()))
+                    != static_cast<qint64>(signedImage.size())) {
+            reason = "Unable to save the signed image.";
+            return Result::Failed;
+        }
+        fileSignedImage.close();
+    }
+
+    if (!writeSigningReceipt(signer->getSigningReceipt())) {
+        reason = "Unable to save the signing receipt.";
+        return Result::Failed;
+    }
+
+    emit progressUpdated(100.f);
+    return Result::Completed;
+}
+
+bool SigningJob::writeSigningReceipt(const std::string &signingReceipt)
+{
+    std::ofstream fileSigningReceipt;
+    fileSigningReceipt.open(fmt::format("{}.sign", outPath_.toStdString()));
+    if (!fileSigningReceipt.is_open()) return false;
+
+    auto time = QDateTime::currentDateTimeUtc();
+    std::string iso8601 { fmt::format(
+            "{}-{}-{}T{}:{}:{}Z", time.date().year(), time.date().month(), time.date().day(),
+            time.time().hour(), time.time().minute(), time.time().second()) };
+    fileSigningReceipt << iso8601 << std::endl;
+    fileSigningReceipt << signingReceipt << std::endl;
+
+    utils::PerceptualHash hash;
+    try {
+        hash = utils::HashCache::getInstance().fingerprintOf(srcPath_).perceptual;
+    } catch (const std::exception &e) {
+        qDebug() << e.what();
+        return false;
+    }
+    fileSigningReceipt << hash.toHex();
+    fileSigningReceipt.close();
+
+    // Only the record is built here, hashing the signed file stays off the GUI thread.
+    record_.emplace(digestOf(outPath_), hash.bits(),
+                    std::vector<char> { signingReceipt.begin(), signingReceipt.end() },
+                    author_.authorID, keyID_, time.toMSecsSinceEpoch());
+    return true;
+}
+
+void SigningJob::recordSignedImage()
+{
+    if (!record_) return;
+
+    const auto image = std::move(*record_);
+    record_.reset();
+    std::uint32_t imageID;
+    std::uint64_t signer;
+    bool isIndexed;
+    try {
+        auto &dbManager = db::DBManager::getInstance();
+        // Signing is deterministic, an image signed again with the same key is already recorded.
+        if (!image.contentDigest.empty()
+            && !dbManager.getSignedImagesByDigest({ image.contentDigest }).empty())
+            return;
+
+        // A source signed before with the same key is already indexed, only its record is added.
+        const auto previous = dbManager.getSignedImagesByPerceptualHash(
+                { static_cast<std::uint64_t>(image.perceptualHash) });
+        isIndexed = std::any_of(previous.begin(), previous.end(), [&image](const auto &other) {
+            return other.keyID == image.keyID;
+        });
+        signer = signerOf(*pbKey_);
+        imageID = dbManager.insertSignedImages({ image }).front();
+    } catch (const std::exception &e) {
+        qDebug() << e.what();
+        return;
+    }
+    if (isIndexed) return;
+
+    // Indexed by its record and its key, so copies separated from their receipt are still recognized as
+    // signed by that key only.
+    auto &index = utils::SimilarityIndex::getInstance();
+    index.insert(static_cast<std::uint64_t>(image.perceptualHash), imageID, signer);
+    if (!index.save()) qDebug() << "Unable to save the similarity index.";
+}
+
+void SigningJob::onSignerProgress(float progress)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // The signer reports from any of its workers, the exchange let a single one of them through.
+    const auto now = Clock::now().time_since_epoch().count();
+    const auto interval = std::chrono::duration_cast<Clock::duration>(progressInterval).count();
+    auto last = lastProgress_.load();
+    if (progress < 100.f
+        && (now - last < interval || !lastProgress_.compare_exchange_strong(last, now)))
+        return;
+
+    emit progressUpdated(progress);
+}
+}
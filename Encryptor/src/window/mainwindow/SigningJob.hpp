@@ -0,0 +1,217 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#pragma once
+#include <QDateTime>
+#include <QFuture>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "codec/ImageSignCodec.hpp"
+#include "db/data/Author.hpp"
+#include "db/data/SignedImage.hpp"
+#include "generator/ICryptoKeyGenerator.hpp"
+#include "utils/PerceptualHash.hpp"
+
+namespace window {
+/**
+ * @brief Job which sign an image and export it with its signing receipt, off the GUI thread.
+ *
+ * The job read the source file, sign it with codec::ImageSignCodec, write the signed file, then write the
+ * signing receipt with the perceptual hash of the source. Large images are signed strip by strip from file
+ * to file, so they are never held in memory. Signals are emitted from the thread running the
+ * job, connect to them with queued connections to update widgets. Progress is throttled so the GUI thread
+ * is not flooded by a large image.
+ */
+class SigningJob : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Minimum interval between two progress updates.
+     */
+    static constexpr std::chrono::milliseconds progressInterval { 100 };
+    /**
+     * @brief Amount of pixels above which an image is signed strip by strip instead of in memory.
+     */
+    static constexpr qint64 largeImagePixels { 100'000'000 };
+
+public:
+    /**
+     * @brief Create job, nothing is done until start(QThreadPool &) is called.
+     *
+     * The size of the embedded key fingerprint is read from utils::ConfigManager here, so a setting
+     * changed while the job is queued does not apply to it.
+     *
+     * @param srcPath Path to the JPEG file to sign.
+     * @param outPath Path to write the signed file to, the receipt is written next to it.
+     * @param image Decoded image of @p srcPath, may be a scaled preview since only the file is signed.
+     * @param pbKey Public key of the author, must not be nullptr.
+     * @param prKey Private key of the author, must not be nullptr.
+     * @param author Information of the author.
+     * @param keyID ID of the key of the author, referenced as db::data::KeyStore.
+     * @param parent Parent of the job.
+     * @throw std::invalid_argument if @p pbKey or @p prKey is nullptr.
+     */
+    SigningJob(QString srcPath, QString outPath, QImage image,
+               std::shared_ptr<const key_generator::ICryptoKeyGenerator> pbKey,
+               std::shared_ptr<const key_generator::ICryptoKeyGenerator> prKey,
+               db::data::Author author, std::uint32_t keyID, QObject *parent = nullptr);
+
+    /**
+     * @brief Queue the job on a thread pool.
+     * @param pool Pool to run the job on, jobs wait for a free thread of the pool in order.
+     * @return Future of the job.
+     */
+    QFuture<void> start(QThreadPool &pool);
+    /**
+     * @brief Cancel the job.
+     *
+     * A queued job finishes as soon as it starts, a running job stops before the signed file is written.
+     * Once the signed file is written the job runs to completion, so the file always has its receipt.
+     */
+    void cancel();
+
+    /**
+     * @brief Check if an image is large enough to be signed strip by strip, only its header is read.
+     *
+     * Signing strip by strip bounds memory by the width of a baseline JPEG file only, a large progressive
+     * file would have to be held whole and is rejected instead.
+     * @param path Path to the image.
+     * @return True if the image has more than largeImagePixels pixels.
+     */
+    static bool isLargeImage(const QString &path);
+    /**
+     * @brief Add the signed image to the ledger of the database and to the similarity index.
+     *
+     * db::DBManager and utils::SimilarityIndex are only written from the GUI thread, call it there once
+     * completed() is received. Nothing is done if the job did not complete or is already recorded.
+     */
+    void recordSignedImage();
+
+public: // Accessors
+    /**
+     * @brief Get path the signed file is written to.
+     */
+    const QString &outPath() const;
+
+signals:
+    /**
+     * @brief Emitted when progress of the job changed.
+     * @param progress Progress in percentage.
+     */
+    void progressUpdated(float progress);
+    /**
+     * @brief Emitted when the signed file and its receipt are written.
+     */
+    void completed();
+    /**
+     * @brief Emitted when the job failed.
+     * @param reason Reason of the failure, readable by the user.
+     */
+    void failed(QString reason);
+    /**
+     * @brief Emitted when the job stopped after cancel() is called.
+     */
+    void cancelled();
+
+private:
+    /**
+     * @brief Outcome of the job.
+     */
+    enum class Result {
+        Completed, /**< Signed file and receipt are written. */
+        Failed, /**< Job failed, see the reason. */
+        Cancelled /**< Job stopped after cancel() is called. */
+    };
+
+private:
+    /**
+     * @brief Run the job and emit the signal of its outcome, on the thread of the pool.
+     */
+    void run();
+    /**
+     * @brief Run every step of the job.
+     * @param reason Reason of the failure, readable by the user, set if Result::Failed is returned.
+     * @return Outcome of the job.
+     */
+    Result sign(QString &reason);
+    /**
+     * @brief Write signing receipt next to the signed file, and build the record of the signed image.
+     * @param signingReceipt Receipt built by the signer.
+     * @return True if the receipt is written.
+     */
+    bool writeSigningReceipt(const std::string &signingReceipt);
+    /**
+     * @brief Forward progress of the signer, at most once per progressInterval, from any thread.
+     * @param progress Progress of the signer in percentage.
+     */
+    void onSignerProgress(float progress);
+
+private:
+    /**
+     * @brief Path to the JPEG file to sign.
+     */
+    QString srcPath_;
+    /**
+     * @brief Path to write the signed file to.
+     */
+    QString outPath_;
+    /**
+     * @brief Decoded image of @p srcPath_.
+     */
+    QImage image_;
+    /**
+     * @brief Public key of the author, shared so the job outlive a key switch in the window.
+     */
+    std::shared_ptr<const key_generator::ICryptoKeyGenerator> pbKey_;
+    /**
+     * @brief Private key of the author.
+     */
+    std::shared_ptr<const key_generator::ICryptoKeyGenerator> prKey_;
+    /**
+     * @brief Information of the author.
+     */
+    db::data::Author author_;
+    /**
+     * @brief ID of the key of the author.
+     */
+    std::uint32_t keyID_;
+    /**
+     * @brief Size of the embedded key fingerprint, 0 to embed the public key.
+     */
+    std::size_t fingerprintSize_;
+    /**
+     * @brief Determine if the job should stop.
+     */
+    std::atomic<bool> cancelled_ { false };
+    /**
+     * @brief Lock of @p signer_.
+     */
+    std::mutex mutexSigner_;
+    /**
+     * @brief Signer while signing is in progress, nullptr otherwise.
+     */
+    codec::ImageSignCodec *signer_ { nullptr };
+    /**
+     * @brief Time of the last forwarded progress update, in ticks of std::chrono::steady_clock.
+     */
+    std::atomic<std::chrono::steady_clock::rep> lastProgress_ { 0 };
+    /**
+     * @brief Record of the signed image, built on the thread of the pool and written by
+     * recordSignedImage() on the GUI thread.
+     */
+    std::optional<db::data::SignedImage> record_;
+};
+}
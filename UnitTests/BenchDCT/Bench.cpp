@@ -0,0 +1,331 @@
+/**********************************************************************************************************************
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *********************************************************************************************************************/
+#include <QImage>
+
+#include <chrono>
+#include <cstdint>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils/BatchDCT.hpp"
+#include "utils/BlockDCT.hpp"
+#include "utils/CPUFeatures.hpp"
+#include "utils/CoefficientPlane.hpp"
+#include "utils/DCT.hpp"
+#include "utils/FastDCT.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Minimum wall time spent on each measurement.
+ */
+constexpr std::chrono::milliseconds minDuration { 250 };
+/**
+ * @brief Amount of blocks transformed per iteration of block and batch measurements.
+ */
+constexpr std::size_t blockPoolSize { 4096 };
+
+/**
+ * @brief Result of a measurement.
+ */
+struct Result
+{
+    /**
+     * @brief Implementation measured.
+     */
+    std::string name;
+    /**
+     * @brief Workload, "block", "batch" or name of the plane.
+     */
+    std::string workload;
+    /**
+     * @brief Width and height of a block.
+     */
+    std::size_t blockSize { 8 };
+    /**
+     * @brief Amount of threads used.
+     */
+    std::size_t threads { 1 };
+    /**
+     * @brief Amount of blocks transformed per iteration.
+     */
+    std::size_t blocks { 0 };
+    /**
+     * @brief Amount of iterations measured.
+     */
+    std::size_t iterations { 0 };
+    /**
+     * @brief Total wall time of the iterations.
+     */
+    double seconds { 0.0 };
+};
+
+/**
+ * @brief Plane size to measure.
+ */
+struct PlaneSize
+{
+    std::string_view name;
+    int width;
+    int height;
+};
+
+/**
+ * @brief Sink of transform results, keeps the compiler from dropping the measured work.
+ */
+volatile float sink { 0.f };
+
+/**
+ * @brief Run @p body repeatedly until minDuration elapsed, after a warm up run.
+ * @param result Result to fill, name, workload and blocks should be set.
+ * @param body Function which transform @p result.blocks blocks.
+ * @return Filled @p result.
+ */
+Result measure(Result result, const std::function<void()> &body)
+{
+    body();
+
+    const auto start = Clock::now();
+    Clock::duration elapsed {};
+    do {
+        body();
+        result.iterations++;
+        elapsed = Clock::now() - start;
+    } while (elapsed < minDuration);
+
+    result.seconds = std::chrono::duration<double>(elapsed).count();
+    return result;
+}
+
+/**
+ * @brief Create blocks of pseudo random level shifted samples.
+ * @tparam Block Type of block.
+ * @param count Amount of blocks.
+ * @return Created blocks.
+ */
+template<typename Block>
+std::vector<Block> makeBlocks(std::size_t count)
+{
+    std::vector<Block> blocks(count);
+    std::uint32_t state { 0x12345678u };
+    for (auto &block : blocks) {
+        for (auto &sample : block) {
+            state = state * 1664525u + 1013904223u;
+            sample = static_cast<typename Block::value_type>(static_cast<int>(state >> 24) - 128);
+        }
+    }
+    return blocks;
+}
+
+/**
+ * @brief Measure single block transforms of a BasicBlockDCT.
+ * @tparam N Width and height of a block.
+ * @param results Results to append.
+ */
+template<std::size_t N>
+void measureBlockDCT(std::vector<Result> &results)
+{
+    using Transform = utils::BasicBlockDCT<N>;
+    const auto blocks = makeBlocks<typename Transform::Block>(blockPoolSize);
+    Transform transform;
+    typename Transform::Block output;
+
+    const auto name = fmt::format("BlockDCT<{}>", N);
+    results.emplace_back(measure({ name, "block", N, 1, blocks.size() }, [&] {
+        for (const auto &block : blocks) {
+            transform.transform(block, output);
+            sink = sink + output[0];
+        }
+    }));
+}
+
+/**
+ * @brief Measure every implementation on single blocks.
+ * @param results Results to append.
+ */
+void measureBlocks(std::vector<Result> &results)
+{
+    using Mode = utils::DCT::Mode;
+
+    // Nested vector API of utils::DCT, which pays for the conversion of every block.
+    std::vector<std::vector<float>> samples(utils::BlockDCT::blockSize,
+                                            std::vector<float>(utils::BlockDCT::blockSize));
+    for (std::size_t idx = 0; idx < utils::BlockDCT::blockArea; idx++)
+        samples[idx / utils::BlockDCT::blockSize][idx % utils::BlockDCT::blockSize] =
+                static_cast<float>((idx * 37) % 256);
+
+    for (auto [mode, name] : { std::pair { Mode::Reference, "DCT::Reference" },
+                               std::pair { Mode::Separable, "DCT::Separable" },
+                               std::pair { Mode::FastFloat, "DCT::FastFloat" },
+                               std::pair { Mode::FastInteger, "DCT::FastInteger" } }) {
+        utils::DCT transform { mode };
+        const std::size_t count { mode == Mode::Reference ? 16u : blockPoolSize };
+        results.emplace_back(measure({ name, "block", 8, 1, count }, [&] {
+            for (std::size_t idx = 0; idx < count; idx++)
+                sink = sink + transform.transfrom(samples)[0][0];
+        }));
+    }
+
+    measureBlockDCT<4>(results);
+    measureBlockDCT<8>(results);
+    measureBlockDCT<16>(results);
+    measureBlockDCT<32>(results);
+
+    utils::FastDCT fast;
+    const auto floatBlocks = makeBlocks<utils::BlockDCT::Block>(blockPoolSize);
+    utils::BlockDCT::Block floatOutput;
+    results.emplace_back(measure({ "FastDCT::Float", "block", 8, 1, floatBlocks.size() }, [&] {
+        for (const auto &block : floatBlocks) {
+            fast.transform(block, floatOutput);
+            sink = sink + floatOutput[0];
+        }
+    }));
+
+    const auto integerBlocks = makeBlocks<utils::FastDCT::IntegerBlock>(blockPoolSize);
+    utils::FastDCT::IntegerBlock integerOutput;
+    results.emplace_back(measure({ "FastDCT::Integer", "block", 8, 1, integerBlocks.size() }, [&] {
+        for (const auto &block : integerBlocks) {
+            fast.transform(block, integerOutput);
+            sink = sink + static_cast<float>(integerOutput[0]);
+        }
+    }));
+}
+
+/**
+ * @brief Measure every vectorized kernel on contiguous blocks.
+ * @param results Results to append.
+ */
+void measureBatches(std::vector<Result> &results)
+{
+    using Backend = utils::BatchDCT::Backend;
+    // The transform is orthonormal, transforming the same blocks over and over keeps them bounded.
+    auto blocks = makeBlocks<utils::BlockDCT::Block>(blockPoolSize);
+
+    for (auto backend : { Backend::Scalar, Backend::SSE2, Backend::AVX2, Backend::AVX512 }) {
+        if (!utils::BatchDCT::isSupported(backend)) continue;
+
+        utils::BatchDCT transform { backend };
+        const auto name = fmt::format("BatchDCT::{}", utils::BatchDCT::nameOf(backend));
+        results.emplace_back(measure({ name, "batch", 8, 1, blocks.size() }, [&] {
+            transform.transformBlocks(blocks.data(), blocks.size());
+            sink = sink + blocks[0][0];
+        }));
+    }
+}
+
+/**
+ * @brief Measure whole plane transforms of utils::DCT.
+ * @param results Results to append.
+ */
+void measurePlanes(std::vector<Result> &results)
+{
+    using Mode = utils::DCT::Mode;
+    constexpr PlaneSize planeSizes[] {
+        { "4K", 3840, 2160 },
+        { "8K", 7680, 4320 },
+        { "24MP", 6000, 4000 },
+    };
+
+    auto &pool = utils::ThreadPool::getInstance();
+    const std::size_t hardwareThreads { pool.threadCount() };
+    std::vector<std::size_t> threadCounts { 1 };
+    if (hardwareThreads > 1) threadCounts.push_back(hardwareThreads);
+
+    for (const auto &planeSize : planeSizes) {
+        QImage image { planeSize.width, planeSize.height, QImage::Format_ARGB32 };
+        for (int y = 0; y < image.height(); y++) {
+            auto line = reinterpret_cast<QRgb *>(image.scanLine(y));
+            for (int x = 0; x < image.width(); x++)
+                line[x] = qRgb(x & 0xff, y & 0xff, (x * y) & 0xff);
+        }
+
+        utils::CoefficientPlane plane;
+        // The reference mode is left out, it takes minutes per plane.
+        for (auto [mode, name] : { std::pair { Mode::Separable, "DCT::Separable" },
+                                   std::pair { Mode::FastFloat, "DCT::FastFloat" },
+                                   std::pair { Mode::FastInteger, "DCT::FastInteger" } }) {
+            utils::DCT transform { mode };
+            for (auto threads : threadCounts) {
+                pool.setThreadCount(threads);
+                plane.resize(image.width(), image.height());
+                const auto blocks = static_cast<std::size_t>(plane.blockCount());
+
+                results.emplace_back(
+                        measure({ name, std::string { planeSize.name }, 8, threads, blocks }, [&] {
+                            transform.transformPlane(image, utils::DCT::Channel::Green, plane);
+                            sink = sink + plane.block(0, 0)[0];
+                        }));
+            }
+        }
+    }
+    pool.setThreadCount(hardwareThreads);
+}
+
+/**
+ * @brief Serialize results into JSON.
+ * @param results Results to serialize.
+ * @return JSON document.
+ */
+std::string toJson(const std::vector<Result> &results)
+{
+    const auto &features = utils::CPUFeatures::getInstance();
+    std::string json { fmt::format(
+            "{{\n  \"benchmark\": \"dct\",\n  \"backend\": \"{}\",\n"
+            "  \"cpu\": {{ \"sse2\": {}, \"avx2\": {}, \"avx512\": {} }},\n  \"results\": [",
+            utils::BatchDCT::nameOf(utils::BatchDCT::detectBackend()), features.hasSSE2(),
+            features.hasAVX2(), features.hasAVX512()) };
+
+    for (std::size_t idx = 0; idx < results.size(); idx++) {
+        const auto &result = results[idx];
+        const double blocks { static_cast<double>(result.blocks * result.iterations) };
+        json += fmt::format(
+                "{}\n    {{ \"name\": \"{}\", \"workload\": \"{}\", \"block_size\": {}, "
+                "\"threads\": {}, \"blocks\": {}, \"iterations\": {}, \"ns_per_block\": {:.3f}, "
+                "\"blocks_per_second\": {:.1f} }}",
+                idx == 0 ? "" : ",", result.name, result.workload, result.blockSize, result.threads,
+                result.blocks, result.iterations, result.seconds * 1e9 / blocks,
+                blocks / result.seconds);
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+}
+
+/**
+ * @brief DCT micro benchmark.
+ *
+ * Measure every transform implementation on single blocks, batches of blocks and whole image planes, then
+ * write the results as JSON into the file given as the first argument, or stdout if none is given.
+ */
+int main(int argc, char **argv)
+{
+    std::vector<Result> results;
+    measureBlocks(results);
+    measureBatches(results);
+    measurePlanes(results);
+
+    const auto json = toJson(results);
+    if (argc < 2) {
+        std::cout << json;
+        return 0;
+    }
+
+    std::ofstream writer { argv[1] };
+    if (!writer.is_open()) {
+        std::cerr << "Unable to open " << argv[1] << std::endl;
+        return 1;
+    }
+    writer << json;
+    return 0;
+}
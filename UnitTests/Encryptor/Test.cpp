@@ -2,19 +2,47 @@
 #include <boost/test/unit_test.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <boost/algorithm/string.hpp>
+#include <boost/math/constants/constants.hpp>
 #include <boost/range/irange.hpp>
+#include <boost/scope_exit.hpp>
 #include <cryptopp/base64.h>
 #include <cryptopp/hex.h>
 #include <cryptopp/osrng.h>
 #include <cryptopp/rsa.h>
+#include <fmt/format.h>
 #include <memory>
+#include <numeric>
 #include <string_view>
+#include <thread>
+#include <tuple>
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QImageWriter>
+#include <QTemporaryDir>
 
 #include "codec/DefaultCodecFactory.hpp"
+#include "codec/SignaturePayload.hpp"
+#include "codec/WatermarkLayout.hpp"
+#include "db/DBManager.hpp"
 #include "generator/DefaultCryptoKeyGeneratorFactory.hpp"
 #include "generator/PublicRSACryptoKeyGenerator.hpp"
+#include "utils/BatchDCT.hpp"
+#include "utils/BlockDCT.hpp"
 #include "utils/DCT.hpp"
+#include "utils/HammingSearch.hpp"
+#include "utils/HashCache.hpp"
+#include "utils/ImageFingerprint.hpp"
+#include "utils/JPEGCoefficients.hpp"
+#include "utils/PerceptualHash.hpp"
+#include "utils/ScaledImageReader.hpp"
+#include "utils/SimilarityIndex.hpp"
+#include "utils/ThreadPool.hpp"
 
 BOOST_AUTO_TEST_CASE(dct_algo_test)
 {
@@ -30,25 +58,165 @@ BOOST_AUTO_TEST_CASE(dct_algo_test)
               { 87.0f, 79.0f, 69.0f, 68.0f, 65.0f, 76.0f, 78.0f, 94.0f } }
         };
 
-        utils::DCT transform;
-        auto result = transform.transfrom(data);
-        auto iresult = transform.itransform(result);
-
-        auto [firstResult, secondResult] = std::mismatch(
-                iresult.begin(), iresult.end(), data.begin(), [](const auto &lhs, const auto &rhs) {
-                    auto [first, second] =
-                            std::mismatch(lhs.begin(), lhs.end(), rhs.begin(),
-                                          [](const auto &lhs, const auto &rhs) {
-                                              return std::roundf(lhs) == std::roundf(rhs);
-                                          });
-                    return (first == lhs.end()) && (second == rhs.end());
-                });
-        BOOST_REQUIRE((firstResult == iresult.end()) && (secondResult == data.end()));
+        using Mode = utils::DCT::Mode;
+        for (auto mode : { Mode::Reference, Mode::Separable, Mode::FastFloat, Mode::FastInteger }) {
+            BOOST_TEST_CONTEXT("mode " << static_cast<int>(mode))
+            {
+                // Coefficients of the integer transform are rounded, which may move a sample by one.
+                const float tolerance { mode == Mode::FastInteger ? 1.f : 0.f };
+                utils::DCT transform { mode };
+                auto result = transform.transfrom(data);
+                auto iresult = transform.itransform(result);
+
+                auto [firstResult, secondResult] = std::mismatch(
+                        iresult.begin(), iresult.end(), data.begin(),
+                        [&](const auto &lhs, const auto &rhs) {
+                            auto [first, second] = std::mismatch(
+                                    lhs.begin(), lhs.end(), rhs.begin(),
+                                    [&](const auto &lhs, const auto &rhs) {
+                                        return std::fabs(std::roundf(lhs) - std::roundf(rhs))
+                                                <= tolerance;
+                                    });
+                            return (first == lhs.end()) && (second == rhs.end());
+                        });
+                BOOST_REQUIRE((firstResult == iresult.end()) && (secondResult == data.end()));
+            }
+        }
     } catch (const std::exception &e) {
         BOOST_FAIL(e.what());
     }
 }
 
+using BlockDCTTypes = std::tuple<utils::BasicBlockDCT<4>, utils::BasicBlockDCT<8>,
+                                 utils::BasicBlockDCT<16>, utils::BasicBlockDCT<32>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(block_dct_test, Transform, BlockDCTTypes)
+{
+    namespace boost_const = boost::math::double_constants;
+    constexpr auto blockSize = Transform::blockSize;
+
+    typename Transform::Block samples;
+    for (auto idx : boost::irange(samples.size()))
+        samples[idx] = static_cast<float>((idx * 37) % 255) - 128.f;
+
+    Transform transform;
+    typename Transform::Block coefficients;
+    transform.transform(samples, coefficients);
+
+    for (auto v : boost::irange(blockSize)) {
+        for (auto u : boost::irange(blockSize)) {
+            double expected { 0.0 };
+            for (auto y : boost::irange(blockSize)) {
+                for (auto x : boost::irange(blockSize)) {
+                    expected += samples[y * blockSize + x]
+                            * std::cos((2.0 * x + 1.0) * u * boost_const::pi / (2.0 * blockSize))
+                            * std::cos((2.0 * y + 1.0) * v * boost_const::pi / (2.0 * blockSize));
+                }
+            }
+            expected *= 2.0 / blockSize * (u == 0 ? boost_const::one_div_root_two : 1.0)
+                    * (v == 0 ? boost_const::one_div_root_two : 1.0);
+            BOOST_CHECK_SMALL(coefficients[v * blockSize + u] - expected, 1e-2);
+        }
+    }
+
+    typename Transform::Block restored;
+    transform.itransform(coefficients, restored);
+    for (auto idx : boost::irange(samples.size()))
+        BOOST_CHECK_SMALL(restored[idx] - samples[idx], 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(batch_dct_test)
+{
+    using Backend = utils::BatchDCT::Backend;
+    std::vector<utils::BlockDCT::Block> blocks(utils::BatchDCT::batchSize * 2 + 3);
+    for (auto idx : boost::irange(blocks.size())) {
+        for (auto sample : boost::irange(utils::BlockDCT::blockArea))
+            blocks[idx][sample] = static_cast<float>((idx * 31 + sample * 17) % 255) - 128.f;
+    }
+
+    auto expected = blocks;
+    utils::BlockDCT reference;
+    for (auto &block : expected) reference.transform(block, block);
+
+    for (auto backend : { Backend::Scalar, Backend::SSE2, Backend::AVX2, Backend::AVX512 }) {
+        if (!utils::BatchDCT::isSupported(backend)) continue;
+        BOOST_TEST_MESSAGE(utils::BatchDCT::nameOf(backend));
+
+        utils::BatchDCT transform { backend };
+        auto coefficients = blocks;
+        transform.transformBlocks(coefficients.data(), coefficients.size());
+        for (auto idx : boost::irange(blocks.size())) {
+            for (auto sample : boost::irange(utils::BlockDCT::blockArea))
+                BOOST_CHECK_SMALL(coefficients[idx][sample] - expected[idx][sample], 1e-3f);
+        }
+
+        transform.itransformBlocks(coefficients.data(), coefficients.size());
+        for (auto idx : boost::irange(blocks.size())) {
+            for (auto sample : boost::irange(utils::BlockDCT::blockArea))
+                BOOST_CHECK_SMALL(coefficients[idx][sample] - blocks[idx][sample], 1e-3f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dct_plane_test)
+{
+    QImage image { 21, 13, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgba(x * 10, y * 7, (x * y * 5 + 3) % 256, 200));
+    }
+
+    utils::DCT transform;
+    utils::CoefficientPlane plane;
+    transform.transformPlane(image, utils::DCT::Channel::Blue, plane);
+    BOOST_REQUIRE(plane.blockColumns() == 3 && plane.blockRows() == 2);
+    BOOST_REQUIRE(reinterpret_cast<std::uintptr_t>(plane.data()) % utils::CoefficientPlane::alignment
+                  == 0);
+
+    QImage restored { image };
+    restored.fill(Qt::GlobalColor::black);
+    transform.itransformPlane(plane, utils::DCT::Channel::Blue, restored);
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            BOOST_REQUIRE(qBlue(restored.pixel(x, y)) == qBlue(image.pixel(x, y)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_test)
+{
+    auto &pool = utils::ThreadPool::getInstance();
+    BOOST_REQUIRE(pool.threadCount() > 0);
+
+    std::vector<int> visited(1000, 0);
+    pool.parallelFor(visited.size(), [&](std::size_t idx) {
+        std::vector<int> inner(4, 0);
+        pool.parallelFor(inner.size(), [&](std::size_t innerIdx) { inner[innerIdx] = 1; });
+        visited[idx] = std::accumulate(inner.begin(), inner.end(), 0);
+    });
+    BOOST_REQUIRE(std::all_of(visited.begin(), visited.end(), [](int value) { return value == 4; }));
+
+    std::atomic<std::size_t> finished { 0 };
+    BOOST_REQUIRE_THROW(pool.parallelFor(64,
+                                         [&](std::size_t idx) {
+                                             if (idx == 7) throw std::runtime_error { "Task failed." };
+                                             finished++;
+                                         }),
+                        std::runtime_error);
+    BOOST_REQUIRE(finished == 63);
+
+    // The count includes the calling thread, a single thread runs every task inline.
+    const std::size_t threadCount { pool.threadCount() };
+    pool.setThreadCount(1);
+    BOOST_REQUIRE_EQUAL(pool.threadCount(), 1);
+    const auto caller = std::this_thread::get_id();
+    std::vector<std::thread::id> runners(16);
+    pool.parallelFor(runners.size(),
+                     [&](std::size_t idx) { runners[idx] = std::this_thread::get_id(); });
+    BOOST_REQUIRE(std::all_of(runners.begin(), runners.end(), [&](auto id) { return id == caller; }));
+    pool.setThreadCount(threadCount);
+    BOOST_REQUIRE_EQUAL(pool.threadCount(), threadCount);
+}
+
 BOOST_AUTO_TEST_CASE(sha3_hasher_test)
 {
     try {
@@ -228,4 +396,738 @@ BOOST_AUTO_TEST_CASE(zlib_compression_test)
         if (static_cast<std::byte>(data[idx]) != rsltDecompress[idx]) BOOST_REQUIRE(false);
     }
     BOOST_REQUIRE(true);
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(signature_payload_test)
+{
+    using namespace std::string_view_literals;
+    const std::string longName(300, 'a');
+    const codec::SignaturePayload::Fields fields {
+        codec::SignaturePayload::KeyFormat::PublicKey, "\xc3\x5a"sv, "\x01\x00\x01"sv, ""sv,
+        longName, "author@example.com"sv, ""sv
+    };
+    const std::array<std::byte, 4> sign { std::byte { 1 }, std::byte { 2 }, std::byte { 3 },
+                                          std::byte { 4 } };
+
+    auto data = codec::SignaturePayload::writeSigned(fields, sign.size());
+    const auto szSigned = data.size();
+    codec::SignaturePayload::appendSignature(data, sign.data(), sign.size());
+    BOOST_REQUIRE_EQUAL(data.size(), codec::SignaturePayload::size(fields, sign.size()));
+    BOOST_REQUIRE_EQUAL(data.size(), data.capacity());
+
+    const codec::SignaturePayload payload { data.data(), data.size() };
+    BOOST_REQUIRE(payload.fields().modulus == fields.modulus);
+    BOOST_REQUIRE(payload.fields().exponent == fields.exponent);
+    BOOST_REQUIRE(payload.fields().authorName == longName);
+    BOOST_REQUIRE(payload.fields().authorEmail == fields.authorEmail);
+    BOOST_REQUIRE(payload.fields().authorPortFolioURL.empty());
+    BOOST_REQUIRE_EQUAL(payload.signedData().size(), szSigned);
+    BOOST_REQUIRE(payload.signature() == "\x01\x02\x03\x04"sv);
+    // Fields are views into the payload.
+    BOOST_REQUIRE(reinterpret_cast<const std::byte *>(payload.signature().data())
+                  == data.data() + data.size() - sign.size());
+
+    BOOST_REQUIRE_THROW(codec::SignaturePayload(data.data(), data.size() - 1), std::runtime_error);
+    BOOST_REQUIRE_THROW(codec::SignaturePayload(data.data(), 0), std::runtime_error);
+    auto trailing = data;
+    trailing.push_back(std::byte { 0 });
+    BOOST_REQUIRE_THROW(codec::SignaturePayload(trailing.data(), trailing.size()),
+                        std::runtime_error);
+    auto otherVersion = data;
+    otherVersion[0] = std::byte { 1 };
+    BOOST_REQUIRE_THROW(codec::SignaturePayload(otherVersion.data(), otherVersion.size()),
+                        std::runtime_error);
+
+    auto tooLarge = codec::SignaturePayload::writeSigned(fields, 2);
+    BOOST_REQUIRE_THROW(
+            codec::SignaturePayload::appendSignature(tooLarge, sign.data(), sign.size()),
+            std::length_error);
+
+    const auto fingerprint = codec::SignaturePayload::fingerprint(
+            "key"sv, codec::SignaturePayload::shortFingerprintSize);
+    BOOST_REQUIRE(fingerprint
+                  == codec::SignaturePayload::fingerprint(
+                             "key"sv, codec::SignaturePayload::fullFingerprintSize)
+                             .substr(0, codec::SignaturePayload::shortFingerprintSize));
+    BOOST_REQUIRE_THROW(codec::SignaturePayload::fingerprint("key"sv, 20), std::invalid_argument);
+
+    auto fingerprintFields = fields;
+    fingerprintFields.keyFormat = codec::SignaturePayload::KeyFormat::Fingerprint;
+    fingerprintFields.fingerprint = fingerprint;
+    auto fingerprintData = codec::SignaturePayload::writeSigned(fingerprintFields, sign.size());
+    codec::SignaturePayload::appendSignature(fingerprintData, sign.data(), sign.size());
+    const codec::SignaturePayload fingerprintPayload { fingerprintData.data(),
+                                                       fingerprintData.size() };
+    BOOST_REQUIRE(fingerprintPayload.fields().keyFormat
+                  == codec::SignaturePayload::KeyFormat::Fingerprint);
+    BOOST_REQUIRE(fingerprintPayload.fields().fingerprint == fingerprint);
+    BOOST_REQUIRE(fingerprintPayload.fields().modulus.empty());
+    BOOST_REQUIRE(fingerprintPayload.fields().authorName == longName);
+
+    fingerprintFields.fingerprint = "short"sv;
+    BOOST_REQUIRE_THROW(codec::SignaturePayload::writeSigned(fingerprintFields, sign.size()),
+                        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(image_sign_extract_test)
+{
+    std::unique_ptr<key_generator::ICryptoKeyGeneratorFactory> keyFactory {
+        std::make_unique<key_generator::DefaultCryptoKeyGeneratorFactory>()
+    };
+    auto keyParams = keyFactory->generateASymParams();
+    auto prKeyGen = keyFactory->createDefaultPrivateASymEncryptionKey(*keyParams);
+    prKeyGen->generate();
+    auto pbKeyGen = keyFactory->createDefaultPublicASymEncryptionKey(*keyParams);
+    pbKeyGen->generate();
+    const db::data::Author author { "Author", "author@example.com", "https://example.com" };
+
+    QImage image { 320, 240, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgb((x * 3) % 256, (y * 5) % 256, x < 160 ? 255 : 0));
+    }
+
+    std::unique_ptr<codec::ICodecFactory> facCodec {
+        std::make_unique<codec::DefaultCodecFactory>()
+    };
+    auto signer =
+            facCodec->createDefaultImageSigner(image, pbKeyGen.get(), prKeyGen.get(), &author);
+    // Bands report from the workers, the last report is always 100 percent from the calling thread.
+    std::atomic<float> lastProgress { 0.f };
+    QObject::connect(signer.get(), &codec::ImageSignCodec::progressUpdated,
+                     [&](float progress) { lastProgress = progress; });
+    signer->execute();
+    BOOST_REQUIRE_EQUAL(lastProgress.load(), 100.f);
+
+    auto extractor = facCodec->createDefaultImageSignExtractor(signer->getEncodedImage());
+    extractor->execute();
+    auto decompressor = facCodec->createDefaultDecompressCoder(extractor->getCodecResult());
+    decompressor->execute();
+    BOOST_REQUIRE(decompressor->getCodecResult() == signer->buildSignatureText());
+
+    const auto &extracted = decompressor->getCodecResult();
+    const codec::SignaturePayload payload { extracted.data(), extracted.size() };
+    BOOST_REQUIRE(payload.fields().authorName == author.authorName);
+    CryptoPP::RSA::PublicKey pbKey;
+    const auto toInteger = [](std::string_view field) {
+        return CryptoPP::Integer { reinterpret_cast<const CryptoPP::byte *>(field.data()),
+                                   field.size() };
+    };
+    pbKey.Initialize(toInteger(payload.fields().modulus), toInteger(payload.fields().exponent));
+    CryptoPP::RSASSA_PKCS1v15_SHA_Verifier verifier { pbKey };
+    BOOST_REQUIRE(verifier.VerifyMessage(
+            reinterpret_cast<const CryptoPP::byte *>(payload.signedData().data()),
+            payload.signedData().size(),
+            reinterpret_cast<const CryptoPP::byte *>(payload.signature().data()),
+            payload.signature().size()));
+
+    // Embedding the fingerprint instead of the public key shrinks the payload, the key is resolved
+    // from the fingerprint of its DER encoding.
+    auto fingerprintSigner =
+            facCodec->createDefaultImageSigner(image, pbKeyGen.get(), prKeyGen.get(), &author);
+    BOOST_REQUIRE_THROW(fingerprintSigner->setFingerprintSize(20), std::invalid_argument);
+    fingerprintSigner->setFingerprintSize(codec::SignaturePayload::shortFingerprintSize);
+    const auto fingerprintText = fingerprintSigner->buildSignatureText();
+    BOOST_REQUIRE_LT(fingerprintText.size() + 300, extracted.size());
+    const codec::SignaturePayload fingerprintPayload { fingerprintText.data(),
+                                                       fingerprintText.size() };
+    const auto &derPbKey = pbKeyGen->getGeneratedKey();
+    BOOST_REQUIRE(fingerprintPayload.fields().fingerprint
+                  == codec::SignaturePayload::fingerprint(
+                          { reinterpret_cast<const char *>(derPbKey.data()), derPbKey.size() },
+                          codec::SignaturePayload::shortFingerprintSize));
+    BOOST_REQUIRE(verifier.VerifyMessage(
+            reinterpret_cast<const CryptoPP::byte *>(fingerprintPayload.signedData().data()),
+            fingerprintPayload.signedData().size(),
+            reinterpret_cast<const CryptoPP::byte *>(fingerprintPayload.signature().data()),
+            fingerprintPayload.signature().size()));
+
+    // Signing an image moved in keeps the caller's pixel buffer, no copy is made.
+    auto inPlace = image.copy();
+    const auto *pixels = inPlace.constBits();
+    auto inPlaceSigner =
+            facCodec->createDefaultImageSigner({}, pbKeyGen.get(), prKeyGen.get(), &author);
+    inPlaceSigner->setImage(std::move(inPlace));
+    inPlaceSigner->execute();
+    const auto signedInPlace = inPlaceSigner->getEncodedImage();
+    BOOST_REQUIRE(signedInPlace.constBits() == pixels);
+    BOOST_REQUIRE(inPlaceSigner->getEncodedImage().isNull());
+
+    auto tooSmall = facCodec->createDefaultImageSigner(image.copy(0, 0, 16, 16), pbKeyGen.get(),
+                                                       prKeyGen.get(), &author);
+    BOOST_REQUIRE_THROW(tooSmall->execute(), std::length_error);
+
+    auto cancelled =
+            facCodec->createDefaultImageSigner(image, pbKeyGen.get(), prKeyGen.get(), &author);
+    cancelled->cancel();
+    BOOST_REQUIRE_THROW(cancelled->execute(), std::runtime_error);
+
+    auto extractorUnsigned = facCodec->createDefaultImageSignExtractor(image);
+    BOOST_REQUIRE_THROW(extractorUnsigned->execute(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(jpeg_sign_extract_test)
+{
+    std::unique_ptr<key_generator::ICryptoKeyGeneratorFactory> keyFactory {
+        std::make_unique<key_generator::DefaultCryptoKeyGeneratorFactory>()
+    };
+    auto keyParams = keyFactory->generateASymParams();
+    auto prKeyGen = keyFactory->createDefaultPrivateASymEncryptionKey(*keyParams);
+    prKeyGen->generate();
+    auto pbKeyGen = keyFactory->createDefaultPublicASymEncryptionKey(*keyParams);
+    pbKeyGen->generate();
+    const db::data::Author author { "Author", "author@example.com", "https://example.com" };
+
+    QImage image { 320, 240, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgb((x * 7) % 256, (y * 3) % 256, (x * y) % 256));
+    }
+    QByteArray encoded;
+    QBuffer bufEncoded { &encoded };
+    bufEncoded.open(QIODevice::WriteOnly);
+    BOOST_REQUIRE(image.save(&bufEncoded, "JPG", 75));
+    const std::vector<std::byte> jpeg { reinterpret_cast<const std::byte *>(encoded.constData()),
+                                        reinterpret_cast<const std::byte *>(encoded.constData())
+                                                + encoded.size() };
+
+    std::unique_ptr<codec::ICodecFactory> facCodec {
+        std::make_unique<codec::DefaultCodecFactory>()
+    };
+    auto signer =
+            facCodec->createDefaultImageSigner(image, pbKeyGen.get(), prKeyGen.get(), &author);
+    signer->setCodecData(jpeg);
+    signer->execute();
+    const auto &signedJPEG = signer->getCodecResult();
+    // Zero carriers flipped to 1 add coefficients to encode, the file may only grow slightly.
+    BOOST_REQUIRE_LT(signedJPEG.size(), jpeg.size() * 105 / 100);
+
+    // Only the carrying coefficients may change, everything else is copied from the source file.
+    utils::JPEGCoefficients source { jpeg };
+    utils::JPEGCoefficients target { signedJPEG };
+    BOOST_REQUIRE(source.blockColumns() == target.blockColumns());
+    BOOST_REQUIRE(source.blockRows() == target.blockRows());
+    for (auto row : boost::irange(source.blockRows())) {
+        for (auto col : boost::irange(source.blockColumns())) {
+            for (auto idx : boost::irange(utils::JPEGCoefficients::blockSize
+                                          * utils::JPEGCoefficients::blockSize)) {
+                const auto change = target.block(col, row)[idx] - source.block(col, row)[idx];
+                BOOST_REQUIRE(change >= -1 && change <= 1);
+            }
+        }
+    }
+
+    auto extractor = facCodec->createDefaultImageSignExtractor({});
+    extractor->setCodecData(signedJPEG);
+    extractor->execute();
+    auto decompressor = facCodec->createDefaultDecompressCoder(extractor->getCodecResult());
+    decompressor->execute();
+    BOOST_REQUIRE(decompressor->getCodecResult() == signer->buildSignatureText());
+}
+
+BOOST_AUTO_TEST_CASE(watermark_header_test)
+{
+    using Layout = codec::WatermarkLayout;
+
+    QImage image { 320, 240, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgb((x * 5) % 256, (y * 7) % 256, (x + y) % 256));
+    }
+    QByteArray encoded;
+    QBuffer bufEncoded { &encoded };
+    bufEncoded.open(QIODevice::WriteOnly);
+    BOOST_REQUIRE(image.save(&bufEncoded, "JPG", 90));
+    const std::vector<std::byte> jpeg { reinterpret_cast<const std::byte *>(encoded.constData()),
+                                        reinterpret_cast<const std::byte *>(encoded.constData())
+                                                + encoded.size() };
+
+    // Write the watermark straight into the parity of the quantized coefficients, the header could
+    // then be forged byte by byte.
+    const auto forge = [&jpeg](const std::vector<std::uint8_t> &watermark) {
+        utils::JPEGCoefficients coefficients { jpeg };
+        const std::size_t col { static_cast<std::size_t>(coefficients.blockColumns()) };
+        for (auto idxBit : boost::irange(watermark.size() * 8)) {
+            const std::size_t idxBlock { idxBit / Layout::bitsPerBlock };
+            const auto &[posX, posY] = Layout::positions[idxBit % Layout::bitsPerBlock];
+            auto &coefficient =
+                    coefficients.block(static_cast<int>(idxBlock % col),
+                                       static_cast<int>(idxBlock / col))[posY * Layout::blockSize
+                                                                         + posX];
+            const bool bit { ((watermark[idxBit / 8] >> (idxBit % 8)) & 1) != 0 };
+            if (Layout::bitOfQuantized(coefficient) != bit)
+                coefficient = static_cast<std::int16_t>(coefficient + (coefficient > 0 ? -1 : 1));
+        }
+        return coefficients.save();
+    };
+    const auto header = [](std::uint8_t version, std::uint32_t szPayload) {
+        std::vector<std::uint8_t> bytes { Layout::magic.begin(), Layout::magic.end() };
+        bytes.push_back(version);
+        for (auto idx : boost::irange(Layout::lengthSize))
+            bytes.push_back(static_cast<std::uint8_t>(szPayload >> (idx * 8)));
+        return bytes;
+    };
+    const auto hasMessage = [](std::string_view message) {
+        return [message](const std::runtime_error &e) { return e.what() == message; };
+    };
+
+    std::unique_ptr<codec::ICodecFactory> facCodec {
+        std::make_unique<codec::DefaultCodecFactory>()
+    };
+    auto extractor = facCodec->createDefaultImageSignExtractor({});
+
+    // A single wrong byte of magic tells an unsigned image apart.
+    auto badMagic = header(Layout::version, 4);
+    badMagic[3] = 'X';
+    extractor->setCodecData(forge(badMagic));
+    BOOST_CHECK_EXCEPTION(extractor->execute(), std::runtime_error,
+                          hasMessage("No signature found"));
+
+    extractor->setCodecData(forge(header(static_cast<std::uint8_t>(Layout::version + 1), 4)));
+    BOOST_CHECK_EXCEPTION(extractor->execute(), std::runtime_error,
+                          hasMessage("Unsupported signature version"));
+
+    const std::size_t szBytes { Layout::capacity(image.width(), image.height()) / 8 };
+    extractor->setCodecData(
+            forge(header(Layout::version, static_cast<std::uint32_t>(szBytes))));
+    BOOST_CHECK_EXCEPTION(extractor->execute(), std::runtime_error,
+                          hasMessage("No signature found"));
+
+    // Extraction stops at the encoded length, the bytes written after the payload are left out.
+    const std::vector<std::uint8_t> payload { 0x12, 0x34, 0x56, 0x78, 0x9a };
+    auto watermark = header(Layout::version, static_cast<std::uint32_t>(payload.size()));
+    watermark.insert(watermark.end(), payload.begin(), payload.end());
+    watermark.insert(watermark.end(), 16, 0xff);
+    extractor->setCodecData(forge(watermark));
+    extractor->execute();
+    const auto &extracted = extractor->getCodecResult();
+    BOOST_REQUIRE_EQUAL(extracted.size(), payload.size());
+    for (auto idx : boost::irange(payload.size()))
+        BOOST_REQUIRE_EQUAL(static_cast<std::uint8_t>(extracted[idx]), payload[idx]);
+}
+
+BOOST_AUTO_TEST_CASE(jpeg_stream_sign_extract_test)
+{
+    std::unique_ptr<key_generator::ICryptoKeyGeneratorFactory> keyFactory {
+        std::make_unique<key_generator::DefaultCryptoKeyGeneratorFactory>()
+    };
+    auto keyParams = keyFactory->generateASymParams();
+    auto prKeyGen = keyFactory->createDefaultPrivateASymEncryptionKey(*keyParams);
+    prKeyGen->generate();
+    auto pbKeyGen = keyFactory->createDefaultPublicASymEncryptionKey(*keyParams);
+    pbKeyGen->generate();
+    const db::data::Author author { "Author", "author@example.com", "https://example.com" };
+
+    QImage image { 333, 251, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgb((x * 7) % 256, (y * 3) % 256, (x * y) % 256));
+    }
+    QTemporaryDir dir;
+    BOOST_REQUIRE(dir.isValid());
+    const auto srcPath = QFile::encodeName(dir.filePath("source.jpg")).toStdString();
+    const auto outPath = QFile::encodeName(dir.filePath("signed.jpg")).toStdString();
+    BOOST_REQUIRE(image.save(QString::fromStdString(srcPath), "JPG", 90));
+
+    std::unique_ptr<codec::ICodecFactory> facCodec {
+        std::make_unique<codec::DefaultCodecFactory>()
+    };
+    auto signer = facCodec->createDefaultImageSigner({}, pbKeyGen.get(), prKeyGen.get(), &author);
+    signer->setStreamPaths(srcPath, outPath);
+    signer->execute();
+    BOOST_REQUIRE(signer->getCodecResult().empty());
+
+    // Streamed files are signed in their pixels, the extractor falls back to the decoded image.
+    QImage signedImage { QString::fromStdString(outPath) };
+    BOOST_REQUIRE(signedImage.size() == image.size());
+    auto extractor = facCodec->createDefaultImageSignExtractor(signedImage);
+    extractor->execute();
+    auto decompressor = facCodec->createDefaultDecompressCoder(extractor->getCodecResult());
+    decompressor->execute();
+    BOOST_REQUIRE(decompressor->getCodecResult() == signer->buildSignatureText());
+
+    auto cancelled =
+            facCodec->createDefaultImageSigner({}, pbKeyGen.get(), prKeyGen.get(), &author);
+    cancelled->setStreamPaths(srcPath, outPath + ".cancelled");
+    cancelled->cancel();
+    BOOST_REQUIRE_THROW(cancelled->execute(), std::runtime_error);
+    BOOST_REQUIRE(!QFile::exists(QString::fromStdString(outPath + ".cancelled")));
+
+    // A progressive file could not be decoded strip by strip, it is rejected before anything is written.
+    const auto progressivePath = QFile::encodeName(dir.filePath("progressive.jpg")).toStdString();
+    QImageWriter writer { QString::fromStdString(progressivePath), "JPG" };
+    writer.setProgressiveScanWrite(true);
+    BOOST_REQUIRE(writer.write(image));
+    auto progressive =
+            facCodec->createDefaultImageSigner({}, pbKeyGen.get(), prKeyGen.get(), &author);
+    progressive->setStreamPaths(progressivePath, outPath + ".progressive");
+    BOOST_REQUIRE_THROW(progressive->execute(), std::domain_error);
+    BOOST_REQUIRE(!QFile::exists(QString::fromStdString(outPath + ".progressive")));
+}
+
+BOOST_AUTO_TEST_CASE(perceptual_hash_test)
+{
+    const auto parsed = utils::PerceptualHash::fromHex(" 80427f027f5e7f12\n");
+    BOOST_REQUIRE_EQUAL(parsed.bits(), 0x80427F027F5E7F12ull);
+    BOOST_REQUIRE_EQUAL(parsed.toHex(), "80427F027F5E7F12");
+    BOOST_REQUIRE_EQUAL(utils::PerceptualHash { 1 }.toHex(), "0000000000000001");
+    BOOST_REQUIRE_EQUAL(parsed.distance(utils::PerceptualHash { 0x80427F027F5E7F13ull }), 1);
+    BOOST_REQUIRE_EQUAL(parsed.distance(utils::PerceptualHash { ~parsed.bits() }), 64);
+    BOOST_REQUIRE_THROW(utils::PerceptualHash::fromHex("not a hash"), std::invalid_argument);
+    BOOST_REQUIRE_THROW(utils::PerceptualHash::fromHex("80427F027F5E7F1200"),
+                        std::invalid_argument);
+    BOOST_REQUIRE_THROW(utils::PerceptualHash::fromImage({}), std::invalid_argument);
+
+    // A gradient with a blob on its left, so the image is not symmetric.
+    const auto makeImage = [](int width, int height) {
+        QImage image { width, height, QImage::Format_ARGB32 };
+        for (auto y : boost::irange(height)) {
+            for (auto x : boost::irange(width)) {
+                const int dx { x * 4 - width }, dy { y * 2 - height };
+                const bool isBlob { dx * dx * 4 + dy * dy * 4 < width * width / 4 };
+                image.setPixel(x, y, qRgb(x * 255 / width, isBlob ? 255 : 0, y * 255 / height));
+            }
+        }
+        return image;
+    };
+    const auto image = makeImage(640, 480);
+    const auto hash = utils::PerceptualHash::fromImage(image);
+    BOOST_REQUIRE_LE(hash.distance(utils::PerceptualHash::fromImage(makeImage(320, 240))), 8);
+    BOOST_REQUIRE_GE(hash.distance(utils::PerceptualHash::fromImage(image.mirrored(true, false))),
+                     20);
+
+    QTemporaryDir dir;
+    BOOST_REQUIRE(dir.isValid());
+    BOOST_REQUIRE(image.save(dir.filePath("source.jpg"), "JPG", 95));
+    BOOST_REQUIRE_LE(hash.distance(utils::PerceptualHash::fromFile(dir.filePath("source.jpg"))), 8);
+    BOOST_REQUIRE_THROW(utils::PerceptualHash::fromFile(dir.filePath("missing.jpg")),
+                        std::runtime_error);
+
+    // Golden value of str(imagehash.phash(Image.open("golden.png"))).upper(). The image is gray and
+    // already 32x32, Pillow converts and resizes it without changing a sample, so the hash is exact.
+    QImage golden { 32, 32, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(golden.height())) {
+        for (auto x : boost::irange(golden.width())) {
+            const int gray { (x * 8 + y * 3 + (x * y) % 7 * 16) % 256 };
+            golden.setPixel(x, y, qRgb(gray, gray, gray));
+        }
+    }
+    BOOST_REQUIRE(golden.save(dir.filePath("golden.png"), "PNG"));
+    BOOST_REQUIRE_EQUAL(utils::PerceptualHash::fromFile(dir.filePath("golden.png")).toHex(),
+                        "C29525863A9EB6AE");
+}
+
+BOOST_AUTO_TEST_CASE(image_fingerprint_test)
+{
+    QImage image { 400, 300, QImage::Format_ARGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width())) {
+            const bool isBlock { x < 150 && y > 100 && y < 200 };
+            image.setPixel(x, y, qRgb(x * 255 / 400, isBlock ? 255 : 0, y * 255 / 300));
+        }
+    }
+
+    const auto fingerprint = utils::ImageFingerprint::fromImage(image);
+    BOOST_REQUIRE_EQUAL(fingerprint.perceptual.bits(),
+                        utils::PerceptualHash::fromImage(image).bits());
+
+    const auto same = fingerprint.distance(fingerprint);
+    BOOST_REQUIRE_EQUAL(same.average + same.difference + same.perceptual + same.wavelet, 0);
+
+    const auto scaled = fingerprint.distance(utils::ImageFingerprint::fromImage(
+            image.scaled(200, 150, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)));
+    BOOST_REQUIRE_LE(scaled.average, 8);
+    BOOST_REQUIRE_LE(scaled.difference, 8);
+    BOOST_REQUIRE_LE(scaled.perceptual, 8);
+    BOOST_REQUIRE_LE(scaled.wavelet, 8);
+
+    const auto mirrored =
+            fingerprint.distance(utils::ImageFingerprint::fromImage(image.mirrored(true, false)));
+    BOOST_REQUIRE_GE(mirrored.average, 16);
+    BOOST_REQUIRE_GE(mirrored.difference, 16);
+    BOOST_REQUIRE_GE(mirrored.perceptual, 16);
+    BOOST_REQUIRE_GE(mirrored.wavelet, 16);
+
+    BOOST_REQUIRE_THROW(utils::ImageFingerprint::fromImage({}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(scaled_image_reader_test)
+{
+    using utils::ScaledImageReader;
+    BOOST_REQUIRE_EQUAL(ScaledImageReader::scaleDenominator({ 4000, 3000 }, { 500, 375 }), 8);
+    BOOST_REQUIRE_EQUAL(ScaledImageReader::scaleDenominator({ 4000, 3000 }, { 501, 375 }), 4);
+    BOOST_REQUIRE_EQUAL(ScaledImageReader::scaleDenominator({ 4001, 3000 }, { 501, 375 }), 8);
+    BOOST_REQUIRE_EQUAL(ScaledImageReader::scaleDenominator({ 1000, 200 }, { 128, 128 }), 1);
+    BOOST_REQUIRE_EQUAL(ScaledImageReader::scaleDenominator({ 100, 100 }, { 1920, 1080 }), 1);
+
+    QImage image { 800, 600, QImage::Format_RGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgb(x * 255 / 800, y * 255 / 600, 128));
+    }
+    QTemporaryDir dir;
+    BOOST_REQUIRE(dir.isValid());
+    const auto jpegPath = dir.filePath("image.jpg");
+    const auto pngPath = dir.filePath("image.png");
+    BOOST_REQUIRE(image.save(jpegPath, "JPG", 95));
+    BOOST_REQUIRE(image.save(pngPath, "PNG"));
+
+    // JPEG files are decoded by libjpeg at a power of two, other files are scaled by Qt.
+    const auto scaledJPEG = ScaledImageReader::read(jpegPath, { 150, 100 });
+    BOOST_REQUIRE(scaledJPEG.size() == QSize(200, 150));
+    BOOST_REQUIRE(qAbs(qRed(scaledJPEG.pixel(100, 75)) - qRed(image.pixel(400, 300))) <= 8);
+    BOOST_REQUIRE(ScaledImageReader::read(jpegPath, { 1920, 1080 }).size() == image.size());
+    BOOST_REQUIRE(ScaledImageReader::read(pngPath, { 150, 100 }).size() == QSize(150, 112));
+    BOOST_REQUIRE(ScaledImageReader::read(dir.filePath("missing.jpg"), { 150, 100 }).isNull());
+}
+
+BOOST_AUTO_TEST_CASE(hamming_search_test)
+{
+    using utils::HammingSearch;
+    using Backend = HammingSearch::Backend;
+
+    // Counts which are not a multiple of any vector width, and span several chunks.
+    std::uint64_t state { 0x9e3779b97f4a7c15ull };
+    const auto next = [&state] {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state ^ (state >> 29);
+    };
+    std::vector<std::uint64_t> hashes(HammingSearch::chunkSize * 2 + 37);
+    for (auto &hash : hashes) hash = next();
+    std::vector<HammingSearch::WideHash> wideHashes(101);
+    for (auto &hash : wideHashes) {
+        for (auto &word : hash) word = next();
+    }
+
+    const std::uint64_t query { hashes[4100] ^ 0x8000000000000101ull };
+    hashes[77] = query ^ 0x3ull;
+    hashes[8200] = query ^ 0x30ull;
+    auto wideQuery = wideHashes[60];
+    wideQuery[3] ^= 0xffull;
+
+    const HammingSearch reference { Backend::Scalar };
+    std::vector<std::uint16_t> expected(hashes.size());
+    reference.distances(query, hashes.data(), hashes.size(), expected.data());
+    for (auto idx : boost::irange(hashes.size()))
+        BOOST_REQUIRE_EQUAL(expected[idx], std::bitset<64> { hashes[idx] ^ query }.count());
+
+    std::vector<std::uint16_t> expectedWide(wideHashes.size());
+    reference.distances(wideQuery, wideHashes.data(), wideHashes.size(), expectedWide.data());
+    BOOST_REQUIRE_EQUAL(expectedWide[60], 8);
+
+    for (auto backend : { Backend::Scalar, Backend::POPCNT, Backend::AVX2 }) {
+        if (!HammingSearch::isSupported(backend)) continue;
+        BOOST_TEST_MESSAGE(HammingSearch::nameOf(backend));
+
+        const HammingSearch search { backend };
+        std::vector<std::uint16_t> distances(hashes.size());
+        search.distances(query, hashes.data(), hashes.size(), distances.data());
+        BOOST_REQUIRE(distances == expected);
+        std::vector<std::uint16_t> wideDistances(wideHashes.size());
+        search.distances(wideQuery, wideHashes.data(), wideHashes.size(), wideDistances.data());
+        BOOST_REQUIRE(wideDistances == expectedWide);
+
+        const auto matches = search.nearest(query, hashes.data(), hashes.size(), 4, 2);
+        BOOST_REQUIRE_EQUAL(matches.size(), 2);
+        BOOST_REQUIRE_EQUAL(matches[0].index, 77);
+        BOOST_REQUIRE_EQUAL(matches[0].distance, 2);
+        BOOST_REQUIRE_EQUAL(matches[1].index, 8200);
+        BOOST_REQUIRE_EQUAL(matches[1].distance, 2);
+        BOOST_REQUIRE_EQUAL(search.nearest(query, hashes.data(), hashes.size(), 4, 5).size(), 3);
+        BOOST_REQUIRE(search.nearest(query, hashes.data(), hashes.size(), 1, 5).empty());
+
+        const auto wideMatches =
+                search.nearest(wideQuery, wideHashes.data(), wideHashes.size(), 256, 1);
+        BOOST_REQUIRE_EQUAL(wideMatches.size(), 1);
+        BOOST_REQUIRE_EQUAL(wideMatches[0].index, 60);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(similarity_index_test)
+{
+    using utils::SimilarityIndex;
+    auto &index = SimilarityIndex::getInstance();
+    QTemporaryDir dir;
+    BOOST_REQUIRE(dir.isValid());
+    const auto path = dir.filePath("signed-hashes.idx");
+    BOOST_REQUIRE(index.load(path));
+    BOOST_REQUIRE_EQUAL(index.size(), 0);
+    BOOST_REQUIRE_THROW(SimilarityIndex::signerOf("short"), std::invalid_argument);
+    const auto signer = SimilarityIndex::signerOf("0123456789abcdef");
+    const auto other = SimilarityIndex::signerOf("fedcba9876543210");
+    BOOST_REQUIRE_NE(signer, other);
+
+    // Enough hashes for small radii to probe the substring tables, while large radii scan them.
+    std::uint64_t state { 0x9e3779b97f4a7c15ull };
+    const auto next = [&state] {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state ^ (state >> 29);
+    };
+    std::vector<std::uint64_t> hashes(70000);
+    for (auto idx : boost::irange(hashes.size())) {
+        hashes[idx] = next();
+        index.insert(hashes[idx], idx, signer);
+    }
+    BOOST_REQUIRE(index.save());
+    BOOST_REQUIRE(index.load(path));
+    BOOST_REQUIRE_EQUAL(index.size(), hashes.size());
+    BOOST_REQUIRE_EQUAL(index.remove(42), 1);
+    index.insert(hashes[7] ^ 0x8000000000000001ull, 100000, other);
+    hashes.push_back(hashes[7] ^ 0x8000000000000001ull);
+
+    for (int radius : { 0, 3, 11, 29 }) {
+        for (auto probe : boost::irange(8)) {
+            const std::uint64_t query { hashes[probe * 1000 + 7] ^ (next() & next() & next()) };
+            std::vector<std::tuple<int, std::uint64_t>> expected;
+            for (auto idx : boost::irange(hashes.size())) {
+                const int distance = std::bitset<64> { hashes[idx] ^ query }.count();
+                if (idx != 42 && distance <= radius)
+                    expected.emplace_back(distance, idx < 70000 ? idx : 100000);
+            }
+            std::sort(expected.begin(), expected.end());
+
+            const auto matches = index.query(query, radius);
+            BOOST_REQUIRE_EQUAL(matches.size(), expected.size());
+            for (auto idx : boost::irange(matches.size())) {
+                BOOST_REQUIRE_EQUAL(matches[idx].distance, std::get<0>(expected[idx]));
+                BOOST_REQUIRE_EQUAL(matches[idx].id, std::get<1>(expected[idx]));
+                const auto expectedSigner = matches[idx].id == 100000 ? other : signer;
+                BOOST_REQUIRE_EQUAL(matches[idx].signer, expectedSigner);
+            }
+        }
+    }
+
+    // Pending removals and insertions are written by the next save.
+    BOOST_REQUIRE(index.save());
+    BOOST_REQUIRE(index.load(path));
+    BOOST_REQUIRE_EQUAL(index.size(), hashes.size() - 1);
+    BOOST_REQUIRE(index.query(hashes[42], 0).empty());
+    BOOST_REQUIRE_EQUAL(index.query(hashes[7], 2).size(), 2);
+
+    // An unrelated image is near some of the hashes, but none within the match radius.
+    const std::uint64_t unrelated { next() };
+    BOOST_REQUIRE(!index.query(unrelated, 29).empty());
+    BOOST_REQUIRE(!index.isSignedBy(unrelated, signer));
+    BOOST_REQUIRE(!index.isSignedBy(unrelated, other));
+    // A copy is only signed by the signer of its nearest hash.
+    BOOST_REQUIRE(index.isSignedBy(hashes[1000] ^ 0x8000000000010001ull, signer));
+    BOOST_REQUIRE(!index.isSignedBy(hashes[1000] ^ 0x8000000000010001ull, other));
+    BOOST_REQUIRE(index.isSignedBy(hashes[7] ^ 0x8000000000000001ull, other));
+    BOOST_REQUIRE(!index.isSignedBy(hashes[7] ^ 0x8000000000000001ull, signer));
+    BOOST_REQUIRE(!index.isSignedBy(hashes[1000] ^ 0x000000ff000000ffull, signer));
+
+    QFile corrupted { dir.filePath("corrupted.idx") };
+    BOOST_REQUIRE(corrupted.open(QIODevice::WriteOnly));
+    corrupted.write("not an index");
+    corrupted.close();
+    BOOST_REQUIRE(!index.load(corrupted.fileName()));
+    BOOST_REQUIRE_EQUAL(index.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(signed_image_ledger_test)
+{
+    // The database is opened relative to the working directory, so the test runs in a fresh one.
+    QTemporaryDir dir;
+    BOOST_REQUIRE(dir.isValid());
+    const auto workingDir = QDir::currentPath();
+    BOOST_REQUIRE(QDir::setCurrent(dir.path()));
+    BOOST_SCOPE_EXIT_ALL(&) { QDir::setCurrent(workingDir); };
+    auto &dbManager = db::DBManager::getInstance();
+    dbManager.initDB();
+
+    // More images than bound by a single lookup, with perceptual hashes using the sign bit.
+    std::vector<db::data::SignedImage> images;
+    for (auto idx : boost::irange(1200)) {
+        const std::uint64_t hash { 0x9e3779b97f4a7c15ull * (idx / 2 + 1) };
+        images.emplace_back(fmt::format("{:064x}", idx), hash, std::vector<char> { 'r', 'c' },
+                            1, idx % 2 + 1, idx);
+    }
+    const auto ids = dbManager.insertSignedImages(images);
+    BOOST_REQUIRE_EQUAL(ids.size(), images.size());
+    BOOST_REQUIRE(std::is_sorted(ids.begin(), ids.end()));
+    BOOST_REQUIRE(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+
+    std::vector<std::string> digests;
+    std::vector<std::uint64_t> hashes;
+    for (auto idx : boost::irange(0, 1200, 2)) {
+        digests.push_back(images[idx].contentDigest);
+        hashes.push_back(static_cast<std::uint64_t>(images[idx].perceptualHash));
+    }
+    digests.push_back("unknown");
+    hashes.push_back(0);
+
+    const auto byDigest = dbManager.getSignedImagesByDigest(digests);
+    BOOST_REQUIRE_EQUAL(byDigest.size(), 600);
+    for (auto idx : boost::irange(byDigest.size())) {
+        const auto &expected = images[idx * 2];
+        BOOST_REQUIRE_EQUAL(byDigest[idx].imageID, ids[idx * 2]);
+        BOOST_REQUIRE_EQUAL(byDigest[idx].contentDigest, expected.contentDigest);
+        BOOST_REQUIRE_EQUAL(byDigest[idx].perceptualHash, expected.perceptualHash);
+        BOOST_REQUIRE(byDigest[idx].signingReceipt == expected.signingReceipt);
+        BOOST_REQUIRE_EQUAL(byDigest[idx].keyID, expected.keyID);
+        BOOST_REQUIRE_EQUAL(byDigest[idx].signedAt, expected.signedAt);
+    }
+
+    // Both images of a perceptual hash are found, one per key.
+    const auto byHash = dbManager.getSignedImagesByPerceptualHash(hashes);
+    BOOST_REQUIRE_EQUAL(byHash.size(), images.size());
+    for (auto idx : boost::irange(byHash.size())) {
+        BOOST_REQUIRE_EQUAL(byHash[idx].imageID, ids[idx]);
+        BOOST_REQUIRE_EQUAL(byHash[idx].perceptualHash, images[idx].perceptualHash);
+        BOOST_REQUIRE_EQUAL(byHash[idx].keyID, images[idx].keyID);
+    }
+    BOOST_REQUIRE(dbManager.getSignedImagesByDigest({}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(hash_cache_test)
+{
+    using utils::HashCache;
+    using utils::ImageFingerprint;
+    auto &cache = HashCache::getInstance();
+    QTemporaryDir dir;
+    BOOST_REQUIRE(dir.isValid());
+    const auto cachePath = dir.filePath("hash-cache.dat");
+    BOOST_REQUIRE(cache.load(cachePath));
+    BOOST_REQUIRE_EQUAL(cache.size(), 0);
+
+    QImage image { 320, 240, QImage::Format_RGB32 };
+    for (auto y : boost::irange(image.height())) {
+        for (auto x : boost::irange(image.width()))
+            image.setPixel(x, y, qRgb(x * 255 / 320, y * 255 / 240, (x * y) & 0xff));
+    }
+    const auto path = dir.filePath("image.png");
+    const auto copyPath = dir.filePath("copy.png");
+    BOOST_REQUIRE(image.save(path, "PNG"));
+    BOOST_REQUIRE(QFile::copy(path, copyPath));
+
+    const auto isSame = [](const ImageFingerprint &lhs, const ImageFingerprint &rhs) {
+        const auto distance = lhs.distance(rhs);
+        return distance.average == 0 && distance.difference == 0 && distance.perceptual == 0
+                && distance.wavelet == 0;
+    };
+    const auto expected = ImageFingerprint::fromFile(path);
+    BOOST_REQUIRE(isSame(cache.fingerprintOf(path), expected));
+    BOOST_REQUIRE(isSame(cache.fingerprintOf(path), expected));
+    // A copy has the same content, it is recognized by its digest.
+    BOOST_REQUIRE(isSame(cache.fingerprintOf(copyPath), expected));
+    BOOST_REQUIRE_EQUAL(cache.size(), 1);
+
+    // Entries appended to the file are loaded back.
+    BOOST_REQUIRE(cache.load(cachePath));
+    BOOST_REQUIRE_EQUAL(cache.size(), 1);
+    BOOST_REQUIRE(isSame(cache.fingerprintOf(copyPath), expected));
+
+    // New content of a known path is fingerprinted again.
+    BOOST_REQUIRE(image.mirrored(true, false).save(copyPath, "PNG"));
+    BOOST_REQUIRE(isSame(cache.fingerprintOf(copyPath), ImageFingerprint::fromFile(copyPath)));
+    BOOST_REQUIRE(!isSame(cache.fingerprintOf(copyPath), expected));
+    BOOST_REQUIRE_EQUAL(cache.size(), 2);
+
+    BOOST_REQUIRE_THROW(cache.fingerprintOf(dir.filePath("missing.png")), std::runtime_error);
+    QFile corrupted { dir.filePath("corrupted.dat") };
+    BOOST_REQUIRE(corrupted.open(QIODevice::WriteOnly));
+    corrupted.write("not a cache");
+    corrupted.close();
+    BOOST_REQUIRE(!cache.load(corrupted.fileName()));
+    BOOST_REQUIRE_EQUAL(cache.size(), 0);
+}